@@ -0,0 +1,64 @@
+/*
+    Beam search for wide boards, where an exact search never finishes.
+
+    The search goes one layer of jumps at a time. Every position of the
+    layer is expanded, children that are the same position (equal Zobrist
+    keys) are merged, and only the `width` best children under an
+    evaluation function form the next layer. The layers shrink by one peg
+    each, so the deepest layer reached holds the fewest pegs found. Layers
+    are expanded and scored on several threads, each taking parents off a
+    shared counter.
+
+    Evaluation functions only compare positions of one layer, which all
+    have the same number of pegs; higher scores are kept. The built-in ones
+    look at isolated pegs (no peg next to them, so nothing can jump them
+    until another peg comes close), a golden-ratio pagoda centred on the
+    board (pegs far from the centre are expensive to bring back) and pegs
+    on corner holes (holes no jump passes over, which have to move away on
+    their own).
+*/
+
+#ifndef BEAM_SEARCH_H
+#define BEAM_SEARCH_H
+
+#include <stddef.h>
+#include <vector>
+#include "wide_board.h"
+
+// Score of a position, higher is better
+typedef double (*WideEvaluation)(const WideBoard &board, void *user);
+
+double wideIsolatedScore(const WideBoard &board, void *user);  // Minus the isolated pegs
+double widePagodaScore(const WideBoard &board, void *user);    // Pagoda weight towards the centre
+double wideCornerScore(const WideBoard &board, void *user);    // Minus the pegs on corner holes
+
+// Called after each layer with its depth in jumps, its peg count, the
+// number of positions kept and the best score among them
+typedef void (*BeamProgress)(int layer, int pegs, size_t positions, double bestScore, void *user);
+
+struct BeamOptions {
+    int width;              // Positions kept per layer
+    int threads;            // Worker threads expanding each layer
+    double seconds;         // Time budget, 0 = none
+    size_t memoryBytes;     // Memory budget for the layers and the move history, 0 = none
+    WideEvaluation evaluate;
+    void *evaluateUser;
+    BeamProgress progress;
+    void *progressUser;
+};
+
+// Width 1000, one thread, no budgets, pagoda evaluation
+BeamOptions defaultBeamOptions();
+
+struct BeamResult {
+    int bestPegs;                // Fewest pegs reached
+    std::vector<WideMove> line;  // Jumps from the start to the best position
+    int layers;                  // Jumps played on that line
+    uint64_t positions;          // Children scored
+    bool exhausted;              // The beam ran out of moves, no budget was hit
+    double seconds;
+};
+
+BeamResult wideBeamSearch(const WideBoard &start, const BeamOptions &options);
+
+#endif /* BEAM_SEARCH_H */
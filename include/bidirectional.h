@@ -0,0 +1,66 @@
+/*
+    Bidirectional (meet-in-the-middle) solver.
+
+    A game played backwards is an ordinary game on the complemented board:
+    undoing a jump from a over b to c needs c filled and a, b empty, which
+    is exactly the jump from a over b to c on the complement. So the
+    positions that can still reach the goal are found by playing forward
+    from the complement of each goal position.
+
+    solveBidirectional() first searches backward from the single pegs of
+    the goal, breadth first, one layer of jumps at a time, keeping only the
+    last layer: a sorted set of canonical positions under the symmetries
+    that keep the goal. It stops before a layer would pass maxPositions, so
+    the memory stays bounded whatever the board. That frontier holds every
+    position of its peg count that can still be won. The forward search is
+    then the depth-first search of Solver, with a dead table, that stops at
+    the frontier's peg count: a position there is won if the frontier
+    holds it and dead otherwise, so none of the deep subtrees below it are
+    searched. The line is the forward search's line to the meeting
+    position followed by a short depth-first search from there.
+
+    The forward search works in rounds: each gets as many nodes as the
+    backward side has done work so far and the frontier grows a layer
+    between them, so neither side runs far ahead of the other. Dead
+    positions stay dead for any frontier, so the dead table carries over.
+
+    Both sides are cut by pagoda functions: a forward position must weigh
+    at least as much as the goal, the complement of a backward position at
+    least as much as the complement of the start. With maxPositions = 0
+    the backward search stops at the goal itself and the forward search
+    runs alone, for comparison.
+*/
+
+#ifndef BIDIRECTIONAL_H
+#define BIDIRECTIONAL_H
+
+#include <stdint.h>
+#include <vector>
+#include "bitboard.h"
+#include "solver.h"
+
+// 128 MiB of frontier and 128 MiB of dead table
+const uint64_t BIDIRECTIONAL_MAX_POSITIONS = (uint64_t)1 << 24;
+const int BIDIRECTIONAL_DEAD_SLOTS_LOG2 = 24;
+
+struct BidirectionalStats {
+    uint64_t nodes;          // Positions expanded by the forward search
+    uint64_t positions;      // Canonical positions of all backward layers built
+    uint64_t frontier;       // Positions of the backward layer the forward search stopped at
+    int forwardDepth;        // Jumps from the start to the frontier
+    int backwardDepth;       // Jumps from the frontier to the goal
+    double seconds;
+};
+
+// Called after each new backward layer with its peg count and size
+typedef void (*BidirectionalProgress)(const char *side, int pegs, uint64_t positions, void *user);
+
+// Search pegs for a line of jumps ending with one peg, on targetHole if it
+// is >= 0. SOLVE_WIN with the line in order, SOLVE_DEAD, or SOLVE_UNKNOWN
+// once the forward search has expanded nodeLimit positions (0 = no limit).
+SolveResult solveBidirectional(GeometryId id, Bitboard pegs, std::vector<Move> &line, int targetHole = -1,
+                               uint64_t maxPositions = BIDIRECTIONAL_MAX_POSITIONS, uint64_t nodeLimit = 0,
+                               BidirectionalStats *stats = NULL, BidirectionalProgress progress = NULL,
+                               void *user = NULL);
+
+#endif /* BIDIRECTIONAL_H */
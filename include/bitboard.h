@@ -0,0 +1,200 @@
+/*
+    Bitboard game engine for Marble Solitaire.
+
+    A position is packed into 64-bit masks over the holes of a Geometry:
+    bit i stands for hole i. Two masks describe a position: `holes` marks
+    the holes of the board and `pegs` marks the holes holding a marble.
+    Move generation is one linear pass over the geometry's flat jump table,
+    and applying a jump toggles its precomputed three-hole mask.
+*/
+
+#ifndef BITBOARD_H
+#define BITBOARD_H
+
+#include <stdint.h>
+#include "geometry.h"
+
+const int MOVE_SET_WORDS = (MAX_JUMPS + 63) / 64;
+
+struct Move {
+    uint8_t from;  // Hole of the jumping peg
+    uint8_t dir;   // Direction
+};
+
+struct Board {
+    Bitboard holes;  // Holes that are part of the board
+    Bitboard pegs;   // Holes holding a marble (always a subset of holes)
+};
+
+/* ################################################################# */
+// Bit helpers //
+
+inline Bitboard bbBit(int index) { return (Bitboard)1 << index; }
+inline bool bbTest(Bitboard bb, int index) { return (bb >> index) & 1; }
+
+inline int bbPopCount(Bitboard bb) { return __builtin_popcountll(bb); }
+
+// Index of the lowest set bit; bb must be non-zero
+inline int bbLowest(Bitboard bb) { return __builtin_ctzll(bb); }
+
+inline Bitboard bbEmpty(const Board &b) { return b.holes & ~b.pegs; }
+
+/* ################################################################# */
+// Board setup //
+
+// Every hole filled except for a single empty one
+inline Board initialBoard(const Geometry &geo, int emptyHole) {
+    Board b;
+    b.holes = geo.allHoles;
+    b.pegs = geo.allHoles & ~bbBit(emptyHole);
+    return b;
+}
+
+/* ################################################################# */
+// Move generation //
+
+// A peg on the from-hole, a peg on the hole it jumps over and an empty landing hole
+inline bool isLegalJump(const Board &b, const Jump &j) {
+    return ((b.pegs >> j.from) & (b.pegs >> j.over) & ~(b.pegs >> j.to) & 1) != 0;
+}
+
+inline bool hasAnyMove(const Geometry &geo, const Board &b) {
+    for (int i = 0; i < geo.numJumps; i++) {
+        if (isLegalJump(b, geo.jumps[i]))
+            return true;
+    }
+    return false;
+}
+
+// Fill moves[] (room for geo.numJumps entries) with every legal jump and
+// return how many were written. Each entry is written unconditionally and
+// only kept if legal, so the pass has no data-dependent branches.
+inline int generateMoves(const Geometry &geo, const Board &b, Move *moves) {
+    int count = 0;
+    for (int i = 0; i < geo.numJumps; i++) {
+        const Jump &j = geo.jumps[i];
+        moves[count].from = j.from;
+        moves[count].dir = j.dir;
+        count += isLegalJump(b, j);
+    }
+    return count;
+}
+
+inline int countMoves(const Geometry &geo, const Board &b) {
+    int count = 0;
+    for (int i = 0; i < geo.numJumps; i++)
+        count += isLegalJump(b, geo.jumps[i]);
+    return count;
+}
+
+/* ################################################################# */
+// Applying moves //
+
+inline const Jump &moveJump(const Geometry &geo, Move m) {
+    return geo.jumps[geo.jumpIndex[m.from][m.dir]];
+}
+
+// A move that exists on this board (whether or not it is currently legal)
+inline bool isJump(const Geometry &geo, Move m) {
+    return m.from < geo.numHoles && m.dir < geo.numDirections && geo.jumpIndex[m.from][m.dir] >= 0;
+}
+
+inline bool isLegalMove(const Geometry &geo, const Board &b, Move m) {
+    return isJump(geo, m) && isLegalJump(b, moveJump(geo, m));
+}
+
+// The from and over holes are emptied and the target is filled, which is the same XOR both ways
+inline void applyMove(const Geometry &geo, Board &b, Move m) { b.pegs ^= moveJump(geo, m).mask; }
+inline void revertMove(const Geometry &geo, Board &b, Move m) { b.pegs ^= moveJump(geo, m).mask; }
+
+// Find the jump from one hole to another; returns false if the holes are not
+// exactly two steps apart in a straight line.
+inline bool findMove(const Geometry &geo, int fromHole, int toHole, Move &m) {
+    if (fromHole < 0 || fromHole >= geo.numHoles)
+        return false;
+    for (int d = 0; d < geo.numDirections; d++) {
+        int j = geo.jumpIndex[fromHole][d];
+        if (j >= 0 && geo.jumps[j].to == toHole) {
+            m.from = (uint8_t)fromHole;
+            m.dir = (uint8_t)d;
+            return true;
+        }
+    }
+    return false;
+}
+
+// Two-byte move encoding for history buffers: from-hole in the upper bits
+// (below MAX_HOLES), direction in the lower three.
+typedef uint16_t PackedMove;
+
+inline PackedMove packMove(Move m) { return (PackedMove)(m.from << 3 | m.dir); }
+
+inline Move unpackMove(PackedMove p) {
+    Move m;
+    m.from = (uint8_t)(p >> 3);
+    m.dir = (uint8_t)(p & 7);
+    return m;
+}
+
+/* ################################################################# */
+// Incremental legal-move tracking //
+
+// Live set of legal jumps as a bitset over the geometry's jump table. A jump
+// only changes the legality of jumps that start, pass over or land on one
+// of its three holes, so after each move only those are re-evaluated.
+struct MoveSet {
+    uint64_t words[MOVE_SET_WORDS];
+};
+
+inline void moveSetAssign(MoveSet &ms, int jump, bool legal) {
+    uint64_t bit = (uint64_t)1 << (jump & 63);
+    ms.words[jump >> 6] = (ms.words[jump >> 6] & ~bit) | (legal ? bit : 0);
+}
+
+inline void initMoveSet(MoveSet &ms, const Geometry &geo, const Board &b) {
+    for (int w = 0; w < MOVE_SET_WORDS; w++)
+        ms.words[w] = 0;
+    for (int i = 0; i < geo.numJumps; i++)
+        moveSetAssign(ms, i, isLegalJump(b, geo.jumps[i]));
+}
+
+// Bring ms up to date after m was applied to (or reverted from) b
+inline void updateMoveSet(MoveSet &ms, const Geometry &geo, const Board &b, Move m) {
+    const Jump &moved = moveJump(geo, m);
+    const int touched[3] = { moved.from, moved.over, moved.to };
+    for (int t = 0; t < 3; t++) {
+        for (int k = geo.touchStart[touched[t]]; k < geo.touchStart[touched[t] + 1]; k++) {
+            int i = geo.touchList[k];
+            moveSetAssign(ms, i, isLegalJump(b, geo.jumps[i]));
+        }
+    }
+}
+
+inline bool moveSetEmpty(const MoveSet &ms) {
+    uint64_t any = 0;
+    for (int w = 0; w < MOVE_SET_WORDS; w++)
+        any |= ms.words[w];
+    return any == 0;
+}
+
+inline bool moveSetContains(const Geometry &geo, const MoveSet &ms, Move m) {
+    if (!isJump(geo, m))
+        return false;
+    int i = geo.jumpIndex[m.from][m.dir];
+    return (ms.words[i >> 6] >> (i & 63)) & 1;
+}
+
+// Pegs that have at least one legal jump
+inline Bitboard movablePegs(const Geometry &geo, const MoveSet &ms) {
+    Bitboard movable = 0;
+    for (int w = 0; w < MOVE_SET_WORDS; w++) {
+        uint64_t bits = ms.words[w];
+        while (bits) {
+            movable |= bbBit(geo.jumps[w * 64 + bbLowest(bits)].from);
+            bits &= bits - 1;
+        }
+    }
+    return movable;
+}
+
+#endif /* BITBOARD_H */
@@ -0,0 +1,53 @@
+/*
+    Catalog of the single-vacancy puzzles of a board.
+
+    Every pair of a start hole (the one empty hole of the start) and a
+    finish hole (where the last peg must end) is a puzzle of its own, 33 x
+    33 of them on the English board. buildCatalog() solves them all as
+    independent jobs spread over threads.
+
+    Pairs that a board symmetry maps onto each other have the same answer,
+    so only one pair of each orbit is searched and the others copy its
+    entry. The jobs are ordered by finish hole and each thread keeps its
+    solver, whose dead table stays valid for every start with the same
+    finish: a thread taking the next job of the same finish starts with
+    the dead positions of the previous ones. Node counts therefore depend
+    on how the jobs fell to the threads; the answers do not.
+*/
+
+#ifndef CATALOG_H
+#define CATALOG_H
+
+#include <stdint.h>
+#include <vector>
+#include "bitboard.h"
+#include "solver.h"
+
+struct CatalogEntry {
+    int start;          // Empty hole of the start position
+    int finish;         // Hole the last peg must end on
+    SolveResult result;
+    int moves;          // Moves of the line found, chains of jumps counting once; exact fewest with minimizeMoves
+    uint64_t nodes;     // Positions expanded for this pair
+    double seconds;     // Wall time of its search
+    int solvedAs;       // Index of the entry searched for this pair's orbit, the entry's own if it was searched
+};
+
+struct CatalogOptions {
+    int threads;
+    uint64_t nodeLimit;   // Per pair, 0 = no limit
+    int pruning;          // SolverPruning flags of the solvers
+    bool minimizeMoves;   // Search the fewest moves (MoveSolver) instead of any line
+};
+
+CatalogOptions defaultCatalogOptions();
+
+// Called as each searched pair finishes, from the thread that searched it
+// (never from two at once), with the number of searches done and to do
+typedef void (*CatalogProgress)(const CatalogEntry &entry, int done, int total, void *user);
+
+// Entries of every pair, entry start * numHoles + finish
+std::vector<CatalogEntry> buildCatalog(GeometryId id, const CatalogOptions &options,
+                                       CatalogProgress progress = NULL, void *user = NULL);
+
+#endif /* CATALOG_H */
@@ -0,0 +1,60 @@
+/*
+    Fewest pegs a position can still be reduced to.
+
+    Once a position cannot be won any more, the useful question is how
+    close to a win it can still get. solve() answers it by depth-first
+    branch and bound: the fewest pegs found so far is the incumbent, and
+    every position whose lower bound is not below it is cut. The lower
+    bound is 1, raised to 2 when the position's class holds no single peg
+    or a pagoda function weighs it below every single peg of its class,
+    and further when no position of its class has that few pegs. The
+    search stops early once a line reaches the root's own lower bound.
+
+    A memo table keyed by canonical position (under all board symmetries,
+    since no target hole is involved) stores the exact value of each
+    position whose search finished and a lower bound for positions cut
+    short, so transpositions are searched once. Like the tables of the
+    other solvers it survives between calls on the same board, so calls
+    along a game get cheaper and a search cut by a node limit resumes.
+*/
+
+#ifndef FEWEST_PEGS_H
+#define FEWEST_PEGS_H
+
+#include <stddef.h>
+#include <vector>
+#include "bitboard.h"
+#include "move_solver.h"
+#include "solver.h"
+
+struct FewestPegsStats {
+    uint64_t nodes;       // Positions expanded
+    uint64_t tableHits;   // Positions answered or cut by the memo table
+    uint64_t boundCuts;   // Positions cut by their lower bound
+    int lowerBound;       // Lower bound of the start
+    double seconds;
+};
+
+class FewestPegsSolver {
+public:
+    explicit FewestPegsSolver(int log2TableSlots = 22);
+
+    // Fewest pegs reachable from pegs and a line of jumps reaching them.
+    // SOLVE_WIN once the value is proven; SOLVE_UNKNOWN if nodeLimit (0 =
+    // no limit) cut the search, with best and line holding the fewest pegs
+    // found so far and a line to them.
+    SolveResult solve(GeometryId id, Bitboard pegs, int &best, std::vector<Move> &line, uint64_t nodeLimit = 0);
+
+    // Statistics of the last solve() call
+    const FewestPegsStats &stats() const { return m_stats; }
+
+    // Forget all memoized values
+    void clear();
+
+private:
+    MoveBoundTable m_table;  // Value * 2 + 1 if exact, value * 2 if a lower bound
+    GeometryId m_tableBoard;
+    FewestPegsStats m_stats;
+};
+
+#endif /* FEWEST_PEGS_H */
@@ -0,0 +1,128 @@
+/*
+    Game state and interactive session for Marble Solitaire.
+
+    GameState holds everything the rules need for one game: the board, the
+    live legal-move set, the undo/redo history, the peg count, the Zobrist
+    key and the win/loss status. It has no globals and no graphics dependencies, is an
+    ordinary copyable value, and only reads the shared constant geometry and
+    engine tables, so any number of games can be played side by side, each
+    on its own thread.
+
+    GameSession adds the state of one player interacting with a game:
+    the selected and hovered holes and the start time. The GLFW frontend
+    owns one session; other clients can own as many as they like.
+*/
+
+#ifndef GAME_STATE_H
+#define GAME_STATE_H
+
+#include <time.h>
+#include "bitboard.h"
+#include "static_engine.h"
+#include "move_history.h"
+#include "zobrist.h"
+
+enum CellState { EMPTY = 0, FILLED = 1, INVALID = 2 };
+
+enum GameStatus { GAME_PLAYING = 0, GAME_WON = 1, GAME_LOST = 2 };
+
+class GameState {
+public:
+    GameState(GeometryId id = GEOMETRY_ENGLISH, int undoDepth = 0);
+
+    // Start a new game on the same board or another one; emptyHole < 0 uses
+    // the geometry's default vacancy. The undo depth is kept.
+    void newGame();
+    void newGame(GeometryId id, int emptyHole = -1);
+
+    // Continue from an arbitrary position (pegs outside the board are
+    // ignored); clears the history
+    void setPosition(Bitboard pegs);
+
+    // Maximum number of undoable moves (0 = unlimited); clears the history
+    void setUndoDepth(int depth) { m_history.setDepth(depth); }
+
+    GeometryId geometryId() const { return m_geometry->id; }
+    const Geometry &geometry() const { return *m_geometry; }
+    const EngineOps &engine() const { return *m_engine; }
+    const Board &board() const { return m_board; }
+    const MoveSet &legalMoves() const { return m_legalMoves; }
+    const MoveHistory &history() const { return m_history; }
+
+    int remainingPegs() const { return m_remainingPegs; }
+
+    // Zobrist key of the current position, kept up to date by every move
+    ZobristKey hash() const { return m_hash; }
+    int countMoves() const { return m_engine->countMoves(m_board.pegs); }
+    GameStatus status() const { return m_status; }
+    bool isOver() const { return m_status != GAME_PLAYING; }
+
+    CellState holeState(int hole) const;
+
+    // Pegs that have at least one legal jump
+    Bitboard movablePegs() const { return ::movablePegs(*m_geometry, m_legalMoves); }
+
+    // Legal jump from startHole to endHole
+    bool isValidMove(int startHole, int endHole) const;
+    bool isValidMove(Move m) const;
+
+    // Play a move; returns false (and changes nothing) if it is not legal.
+    // The redo tail and, past the undo depth, the oldest move are dropped.
+    bool makeMove(int startHole, int endHole);
+    bool makeMove(Move m);
+
+    // Step through the history; return false if there is nothing to undo/redo
+    bool undo();
+    bool redo();
+
+private:
+    void play(Move m);
+    void updateStatus();
+
+    const Geometry *m_geometry;   // Shared constant tables, see geometry.h
+    const EngineOps *m_engine;    // Engine specialized for m_geometry
+    Board m_board;
+    ZobristKey m_hash;
+    MoveSet m_legalMoves;         // Kept in sync with m_board after every move
+    MoveHistory m_history;
+    int m_remainingPegs;
+    GameStatus m_status;
+};
+
+/* ################################################################# */
+// Interactive session //
+
+class GameSession {
+public:
+    GameSession(GeometryId id = GEOMETRY_ENGLISH, int undoDepth = 0);
+
+    // New game (same or another board); clears the selection and restarts the clock
+    void newGame();
+    void newGame(GeometryId id);
+
+    GameState &state() { return m_state; }
+    const GameState &state() const { return m_state; }
+
+    bool hasSelection() const { return m_selectedHole >= 0; }
+    int selectedHole() const { return m_selectedHole; }
+    void clearSelection() { m_selectedHole = -1; }
+
+    int hoverHole() const { return m_hoverHole; }
+    void setHoverHole(int hole) { m_hoverHole = hole; }
+
+    // Handle a click on a hole: the first click selects a peg, the second
+    // tries to jump it there and clears the selection. Returns true if a
+    // move was made.
+    bool clickHole(int hole);
+
+    // Whole seconds since the current game started
+    int elapsedSeconds() const { return (int)difftime(time(NULL), m_startTime); }
+
+private:
+    GameState m_state;
+    int m_selectedHole;  // -1 when no peg is selected
+    int m_hoverHole;     // -1 when the cursor is not over a hole
+    time_t m_startTime;
+};
+
+#endif /* GAME_STATE_H */
@@ -0,0 +1,107 @@
+/*
+    Board geometries for Marble Solitaire.
+
+    A geometry describes which cells of a small grid are holes, how holes are
+    adjacent, and every possible jump on the board as a flat table of
+    (from, over, to) triples. Holes are numbered densely in reading order, so
+    a position on any supported board fits in one 64-bit mask with bit i
+    standing for hole i.
+
+    Square boards use the four orthogonal directions. Triangular and
+    hexagonal boards live on a hex lattice stored in the same grid, where
+    cell (row, col) is also adjacent to (row - 1, col - 1) and (row + 1, col + 1).
+
+    The tables are built at compile time (see geometry_tables.h), so they
+    can also drive the geometry-specialized engine in static_engine.h.
+*/
+
+#ifndef GEOMETRY_H
+#define GEOMETRY_H
+
+#include <stdint.h>
+
+typedef uint64_t Bitboard;
+
+const int MAX_HOLES = 64;
+const int MAX_DIRECTIONS = 6;
+const int MAX_JUMPS = MAX_HOLES * MAX_DIRECTIONS;
+const int MAX_GRID = 16;
+const int MAX_SYMMETRIES = 12;  // Dihedral group of the hex lattice; square boards have 8
+
+enum Lattice { LATTICE_SQUARE = 0, LATTICE_HEX = 1 };
+
+enum GeometryId {
+    GEOMETRY_ENGLISH = 0,     // 33-hole cross
+    GEOMETRY_EUROPEAN = 1,    // 37-hole French board
+    GEOMETRY_WIEGLEB = 2,     // 45-hole 9x9 cross
+    GEOMETRY_TRIANGULAR = 3,  // 15-hole triangle
+    GEOMETRY_HEXAGONAL = 4,   // 37-hole hexagon
+    NUM_GEOMETRIES = 5
+};
+
+// Jump directions; square lattices use the first four
+enum Direction {
+    DIR_UP = 0, DIR_DOWN = 1, DIR_LEFT = 2, DIR_RIGHT = 3,
+    DIR_UP_LEFT = 4, DIR_DOWN_RIGHT = 5
+};
+
+// Grid step of each direction
+const int DIR_ROW_STEP[MAX_DIRECTIONS] = { -1, 1, 0, 0, -1, 1 };
+const int DIR_COL_STEP[MAX_DIRECTIONS] = { 0, 0, -1, 1, -1, 1 };
+
+struct Jump {
+    uint8_t from;   // Hole of the jumping peg
+    uint8_t over;   // Hole that is jumped over
+    uint8_t to;     // Landing hole
+    uint8_t dir;    // Direction of the jump
+    Bitboard mask;  // The three holes, toggled together by the jump
+};
+
+struct Geometry {
+    GeometryId id;
+    const char *name;
+    Lattice lattice;
+    int numDirections;
+
+    int rows, cols;                        // Bounding grid
+    int numHoles;
+    int defaultEmpty;                      // Hole left empty at the start of a game
+    Bitboard allHoles;                     // Bits 0 .. numHoles - 1
+
+    int8_t holeAt[MAX_GRID][MAX_GRID];     // Hole index of a grid cell, -1 if not on the board
+    uint8_t holeRow[MAX_HOLES];
+    uint8_t holeCol[MAX_HOLES];
+    float holeX[MAX_HOLES];                // Layout position in lattice units (y grows downwards)
+    float holeY[MAX_HOLES];
+    int8_t neighbor[MAX_HOLES][MAX_DIRECTIONS];  // Adjacent hole, -1 if none
+
+    int numJumps;
+    Jump jumps[MAX_JUMPS];                 // Flat jump table, sorted by from-hole
+    int16_t jumpIndex[MAX_HOLES][MAX_DIRECTIONS];  // Index into jumps, -1 if no jump
+
+    // Jumps that start on, pass over or land on each hole, stored as one
+    // contiguous list: the jumps touching hole h are
+    // touchList[touchStart[h] .. touchStart[h + 1]).
+    uint16_t touchStart[MAX_HOLES + 1];
+    uint16_t touchList[3 * MAX_JUMPS];
+
+    // Rotations and reflections that map the board onto itself, as hole
+    // permutations: symmetry s moves the peg on hole h to symmetry[s][h].
+    // Symmetry 0 is the identity.
+    int numSymmetries;
+    uint8_t symmetry[MAX_SYMMETRIES][MAX_HOLES];
+};
+
+// Compile-time tables shared for the lifetime of the process
+const Geometry &getGeometry(GeometryId id);
+
+// Look up a geometry by its name ("english", "european", ...); returns false if unknown
+bool findGeometry(const char *name, GeometryId &id);
+
+constexpr int holeIndex(const Geometry &geo, int row, int col) {
+    if (row < 0 || row >= geo.rows || col < 0 || col >= geo.cols)
+        return -1;
+    return geo.holeAt[row][col];
+}
+
+#endif /* GEOMETRY_H */
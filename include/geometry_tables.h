@@ -0,0 +1,237 @@
+/*
+    Compile-time construction of the board geometries.
+
+    Every Geometry is built by a constexpr function from a text layout, so
+    the hole numbering, jump table, touch lists and symmetry permutations
+    are constants. The runtime engine reads them through getGeometry(); the
+    specialized engine in static_engine.h folds them into its code.
+*/
+
+#ifndef GEOMETRY_TABLES_H
+#define GEOMETRY_TABLES_H
+
+#include "geometry.h"
+
+/* ################################################################# */
+// Board layouts, one string per grid row: 'o' is a hole, '.' is not //
+
+constexpr const char *ENGLISH_LAYOUT[] = {
+    "..ooo..",
+    "..ooo..",
+    "ooooooo",
+    "ooooooo",
+    "ooooooo",
+    "..ooo..",
+    "..ooo..",
+    nullptr
+};
+
+constexpr const char *EUROPEAN_LAYOUT[] = {
+    "..ooo..",
+    ".ooooo.",
+    "ooooooo",
+    "ooooooo",
+    "ooooooo",
+    ".ooooo.",
+    "..ooo..",
+    nullptr
+};
+
+constexpr const char *WIEGLEB_LAYOUT[] = {
+    "...ooo...",
+    "...ooo...",
+    "...ooo...",
+    "ooooooooo",
+    "ooooooooo",
+    "ooooooooo",
+    "...ooo...",
+    "...ooo...",
+    "...ooo...",
+    nullptr
+};
+
+// Hex lattice: row r holds holes 0 .. r
+constexpr const char *TRIANGULAR_LAYOUT[] = {
+    "o....",
+    "oo...",
+    "ooo..",
+    "oooo.",
+    "ooooo",
+    nullptr
+};
+
+// Hex lattice: the cells with |row - col| <= 3, a hexagon with four holes per side
+constexpr const char *HEXAGONAL_LAYOUT[] = {
+    "oooo...",
+    "ooooo..",
+    "oooooo.",
+    "ooooooo",
+    ".oooooo",
+    "..ooooo",
+    "...oooo",
+    nullptr
+};
+
+struct GeometrySpec {
+    const char *name;
+    Lattice lattice;
+    const char *const *layout;
+    int emptyRow, emptyCol;
+};
+
+constexpr GeometrySpec GEOMETRY_SPECS[NUM_GEOMETRIES] = {
+    { "english",    LATTICE_SQUARE, ENGLISH_LAYOUT,    3, 3 },
+    { "european",   LATTICE_SQUARE, EUROPEAN_LAYOUT,   3, 3 },
+    { "wiegleb",    LATTICE_SQUARE, WIEGLEB_LAYOUT,    4, 4 },
+    { "triangular", LATTICE_HEX,    TRIANGULAR_LAYOUT, 0, 0 },
+    { "hexagonal",  LATTICE_HEX,    HEXAGONAL_LAYOUT,  3, 3 },
+};
+
+/* ################################################################# */
+// Symmetries //
+
+// Linear maps of grid offsets (row, col) -> (a*row + b*col, c*row + d*col).
+// Square lattices use the eight signed permutations; the hex lattice uses
+// the twelve maps that preserve its six directions.
+struct LatticeMap {
+    int a, b, c, d;
+};
+
+constexpr LatticeMap SQUARE_MAPS[8] = {
+    {  1,  0,  0,  1 }, {  0,  1, -1,  0 }, { -1,  0,  0, -1 }, {  0, -1,  1,  0 },
+    {  1,  0,  0, -1 }, { -1,  0,  0,  1 }, {  0,  1,  1,  0 }, {  0, -1, -1,  0 },
+};
+
+constexpr LatticeMap HEX_MAPS[12] = {
+    {  1,  0,  0,  1 }, {  0, -1,  1, -1 }, { -1,  1, -1,  0 },
+    { -1,  0,  0, -1 }, {  0,  1, -1,  1 }, {  1, -1,  1,  0 },
+    {  0,  1,  1,  0 }, {  1, -1,  0, -1 }, { -1,  0, -1,  1 },
+    {  0, -1, -1,  0 }, { -1,  1,  0,  1 }, {  1,  0,  1, -1 },
+};
+
+// Add every lattice map that carries the hole set onto itself. The map is
+// applied about the origin and then translated so the hole centroids line up.
+constexpr void buildSymmetries(Geometry &geo) {
+    const LatticeMap *maps = geo.lattice == LATTICE_HEX ? HEX_MAPS : SQUARE_MAPS;
+    int numMaps = geo.lattice == LATTICE_HEX ? 12 : 8;
+    int sumRow = 0, sumCol = 0;
+    for (int h = 0; h < geo.numHoles; h++) {
+        sumRow += geo.holeRow[h];
+        sumCol += geo.holeCol[h];
+    }
+    geo.numSymmetries = 0;
+    for (int m = 0; m < numMaps; m++) {
+        const LatticeMap &map = maps[m];
+        int mappedRow = map.a * sumRow + map.b * sumCol;
+        int mappedCol = map.c * sumRow + map.d * sumCol;
+        if ((sumRow - mappedRow) % geo.numHoles != 0 || (sumCol - mappedCol) % geo.numHoles != 0)
+            continue;
+        int shiftRow = (sumRow - mappedRow) / geo.numHoles;
+        int shiftCol = (sumCol - mappedCol) / geo.numHoles;
+        bool valid = true;
+        uint8_t *perm = geo.symmetry[geo.numSymmetries];
+        for (int h = 0; h < geo.numHoles && valid; h++) {
+            int r = geo.holeRow[h], c = geo.holeCol[h];
+            int image = holeIndex(geo, map.a * r + map.b * c + shiftRow, map.c * r + map.d * c + shiftCol);
+            if (image < 0)
+                valid = false;
+            else
+                perm[h] = (uint8_t)image;
+        }
+        if (valid)
+            geo.numSymmetries++;
+    }
+}
+
+/* ################################################################# */
+
+// Fill in holes, adjacency and the jump tables from a layout
+constexpr Geometry buildGeometry(GeometryId id) {
+    const GeometrySpec &spec = GEOMETRY_SPECS[id];
+    Geometry geo{};
+    geo.id = id;
+    geo.name = spec.name;
+    geo.lattice = spec.lattice;
+    geo.numDirections = spec.lattice == LATTICE_HEX ? 6 : 4;
+
+    // Holes, numbered in reading order
+    for (int r = 0; r < MAX_GRID; r++) {
+        for (int c = 0; c < MAX_GRID; c++)
+            geo.holeAt[r][c] = -1;
+    }
+    for (int r = 0; spec.layout[r] != nullptr; r++) {
+        int len = 0;
+        for (; spec.layout[r][len] != '\0'; len++) {
+            if (spec.layout[r][len] != 'o')
+                continue;
+            int h = geo.numHoles++;
+            geo.holeAt[r][len] = (int8_t)h;
+            geo.holeRow[h] = (uint8_t)r;
+            geo.holeCol[h] = (uint8_t)len;
+            if (spec.lattice == LATTICE_HEX) {
+                // Shear the lattice so the six neighbours sit at equal distances
+                geo.holeX[h] = len - 0.5f * r;
+                geo.holeY[h] = r * 0.8660254f;
+            } else {
+                geo.holeX[h] = (float)len;
+                geo.holeY[h] = (float)r;
+            }
+        }
+        if (len > geo.cols)
+            geo.cols = len;
+        geo.rows = r + 1;
+    }
+    geo.allHoles = geo.numHoles == 64 ? ~(Bitboard)0 : ((Bitboard)1 << geo.numHoles) - 1;
+    geo.defaultEmpty = geo.holeAt[spec.emptyRow][spec.emptyCol];
+
+    // Adjacency
+    for (int h = 0; h < geo.numHoles; h++) {
+        for (int d = 0; d < MAX_DIRECTIONS; d++) {
+            geo.neighbor[h][d] = -1;
+            if (d < geo.numDirections)
+                geo.neighbor[h][d] = (int8_t)holeIndex(geo, geo.holeRow[h] + DIR_ROW_STEP[d],
+                                                           geo.holeCol[h] + DIR_COL_STEP[d]);
+        }
+    }
+
+    // Jump table: every (from, over, to) triple in a straight line
+    for (int h = 0; h < geo.numHoles; h++) {
+        for (int d = 0; d < MAX_DIRECTIONS; d++) {
+            geo.jumpIndex[h][d] = -1;
+            int over = geo.neighbor[h][d];
+            if (over < 0 || geo.neighbor[over][d] < 0)
+                continue;
+            Jump &j = geo.jumps[geo.numJumps];
+            j.from = (uint8_t)h;
+            j.over = (uint8_t)over;
+            j.to = (uint8_t)geo.neighbor[over][d];
+            j.dir = (uint8_t)d;
+            j.mask = ((Bitboard)1 << j.from) | ((Bitboard)1 << j.over) | ((Bitboard)1 << j.to);
+            geo.jumpIndex[h][d] = (int16_t)geo.numJumps++;
+        }
+    }
+
+    // Per-hole lists of the jumps that involve it
+    int count = 0;
+    for (int h = 0; h < geo.numHoles; h++) {
+        geo.touchStart[h] = (uint16_t)count;
+        for (int j = 0; j < geo.numJumps; j++) {
+            if (geo.jumps[j].mask & ((Bitboard)1 << h))
+                geo.touchList[count++] = (uint16_t)j;
+        }
+    }
+    geo.touchStart[geo.numHoles] = (uint16_t)count;
+
+    buildSymmetries(geo);
+    return geo;
+}
+
+inline constexpr Geometry GEOMETRY_TABLE[NUM_GEOMETRIES] = {
+    buildGeometry(GEOMETRY_ENGLISH),
+    buildGeometry(GEOMETRY_EUROPEAN),
+    buildGeometry(GEOMETRY_WIEGLEB),
+    buildGeometry(GEOMETRY_TRIANGULAR),
+    buildGeometry(GEOMETRY_HEXAGONAL),
+};
+
+#endif /* GEOMETRY_TABLES_H */
@@ -0,0 +1,33 @@
+/*
+    Read-only memory mapping of a whole file, for the precomputed tables
+    (solvability database, position index) that are used in place from
+    disk and only paged in where they are read.
+*/
+
+#ifndef MAPPED_FILE_H
+#define MAPPED_FILE_H
+
+#include <stddef.h>
+
+class MappedFile {
+public:
+    MappedFile() : m_data(NULL), m_size(0) {}
+    ~MappedFile() { close(); }
+
+    // False if the file does not exist, is empty or cannot be mapped
+    bool open(const char *path);
+    void close();
+
+    bool isOpen() const { return m_data != NULL; }
+    const void *data() const { return m_data; }
+    size_t size() const { return m_size; }
+
+private:
+    MappedFile(const MappedFile &);
+    MappedFile &operator=(const MappedFile &);
+
+    void *m_data;
+    size_t m_size;
+};
+
+#endif /* MAPPED_FILE_H */
@@ -0,0 +1,109 @@
+/*
+    Monte Carlo tree search player for Marble Solitaire.
+
+    For boards where no exact search finishes, MCTS grows a tree of the
+    positions it has tried from the current one. Each iteration walks down
+    the tree choosing children by UCT (mean reward plus an exploration term
+    that shrinks as a child is visited), adds the children of the position
+    it stops at, and finishes the game from there with a playout. Playouts
+    make uniformly random jumps, or with heuristic playouts the better of
+    two random jumps by how far they bring the peg towards the centre of
+    the board. The reward is the share of the pegs removed, 1 for a single
+    peg left.
+
+    Several threads grow one shared tree (tree parallelism). A thread walking
+    through a node adds a virtual loss to it until its playout is backed
+    up, which lowers the node's mean for the others so that they spread
+    over the tree instead of following the same path. Node statistics are
+    atomics and nodes come from a preallocated pool, so the loop takes no
+    lock.
+
+    Solitaire has one player and no chance, so every playout is a line that
+    can be replayed. The player keeps the best line any playout found and
+    plays its first move; the visit counts only decide where to look. When
+    the next position is the one after that move, the rest of the line is
+    kept, so an automatic player never ends worse than a line it has seen.
+*/
+
+#ifndef MCTS_H
+#define MCTS_H
+
+#include <stddef.h>
+#include <vector>
+#include "bitboard.h"
+#include "wide_board.h"
+
+struct MctsOptions {
+    int threads;            // Threads growing the tree
+    double seconds;         // Time budget of one search() call, 0 = none
+    uint64_t playouts;      // Playout budget of one search() call, 0 = none
+    double exploration;     // UCT exploration constant
+    int virtualLoss;        // Visits a thread adds to each node on its path
+    bool heuristicPlayouts; // Prefer jumps towards the centre in playouts
+    uint64_t seed;
+};
+
+// One thread, one second, heuristic playouts
+MctsOptions defaultMctsOptions();
+
+struct MctsStats {
+    uint64_t playouts;  // Playouts since the position was set
+    uint64_t nodes;     // Tree nodes in use
+    int bestPegs;       // Pegs left by the best line
+    double seconds;     // Search time since the position was set
+};
+
+template <class Game> class MctsTree;
+struct BitboardMctsGame;
+struct WideMctsGame;
+
+// MCTS on the bitboard boards
+class MctsPlayer {
+public:
+    // maxNodes caps the tree; once the pool is used up the leaves only
+    // get more playouts
+    explicit MctsPlayer(size_t maxNodes = 1 << 20);
+    ~MctsPlayer();
+
+    // Start a new tree on a position, keeping the rest of the best line
+    // if the position follows its first move
+    void setPosition(GeometryId id, Bitboard pegs);
+
+    // Grow the tree within the budgets of options; the tree and the best
+    // line carry over to the next call on the same position. Stops early
+    // once a line leaves a single peg.
+    void search(const MctsOptions &options);
+
+    // First move of the best line; false if the position has no move
+    bool bestMove(Move &m) const;
+    const std::vector<Move> &bestLine() const;
+    const MctsStats &stats() const;
+
+private:
+    MctsPlayer(const MctsPlayer &);
+    MctsPlayer &operator=(const MctsPlayer &);
+
+    MctsTree<BitboardMctsGame> *m_tree;
+    GeometryId m_board;
+};
+
+// MCTS on wide boards
+class WideMctsPlayer {
+public:
+    explicit WideMctsPlayer(size_t maxNodes = 1 << 20);
+    ~WideMctsPlayer();
+
+    void setPosition(const WideBoard &board);
+    void search(const MctsOptions &options);
+    bool bestMove(WideMove &m) const;
+    const std::vector<WideMove> &bestLine() const;
+    const MctsStats &stats() const;
+
+private:
+    WideMctsPlayer(const WideMctsPlayer &);
+    WideMctsPlayer &operator=(const WideMctsPlayer &);
+
+    MctsTree<WideMctsGame> *m_tree;
+};
+
+#endif /* MCTS_H */
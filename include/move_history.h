@@ -0,0 +1,113 @@
+/*
+    Undo/redo history for Marble Solitaire.
+
+    Moves are stored as two-byte PackedMove values in a single ring buffer.
+    The entries before the cursor are the moves that can be undone, the
+    entries after it are the moves that can be redone. Making a new move
+    drops the redo tail, and once the buffer is full the oldest move is
+    overwritten, so push, undo, redo and trimming are all O(1).
+
+    A depth of 0 means unlimited: the buffer then doubles whenever it fills
+    up, which only happens a logarithmic number of times per session.
+*/
+
+#ifndef MOVE_HISTORY_H
+#define MOVE_HISTORY_H
+
+#include <vector>
+#include "bitboard.h"
+
+class MoveHistory {
+public:
+    MoveHistory(int depth = 0) {
+        setDepth(depth);
+    }
+
+    // Change the maximum number of undoable moves (0 = unlimited). Clears the history.
+    void setDepth(int depth) {
+        m_depth = depth < 0 ? 0 : depth;
+        m_buffer.assign(m_depth > 0 ? m_depth : INITIAL_UNLIMITED_CAPACITY, 0);
+        clear();
+    }
+
+    void clear() {
+        m_head = 0;
+        m_size = 0;
+        m_cursor = 0;
+    }
+
+    int depth() const { return m_depth; }
+    bool isUnlimited() const { return m_depth == 0; }
+
+    int undoCount() const { return m_cursor; }
+    int redoCount() const { return m_size - m_cursor; }
+    bool canUndo() const { return m_cursor > 0; }
+    bool canRedo() const { return m_cursor < m_size; }
+
+    // Record a newly made move; any redo entries are discarded
+    void push(Move m) {
+        m_size = m_cursor;
+        if (m_size == capacity()) {
+            if (isUnlimited()) {
+                grow();
+            } else {
+                // Drop the oldest move by advancing the head
+                m_head = wrap(m_head + 1);
+                m_size--;
+                m_cursor--;
+            }
+        }
+        m_buffer[wrap(m_head + m_size)] = packMove(m);
+        m_size++;
+        m_cursor++;
+    }
+
+    // Step back over the last applied move; returns false if there is none
+    bool undo(Move &m) {
+        if (!canUndo())
+            return false;
+        m_cursor--;
+        m = unpackMove(m_buffer[wrap(m_head + m_cursor)]);
+        return true;
+    }
+
+    // Step forward over the last undone move; returns false if there is none
+    bool redo(Move &m) {
+        if (!canRedo())
+            return false;
+        m = unpackMove(m_buffer[wrap(m_head + m_cursor)]);
+        m_cursor++;
+        return true;
+    }
+
+    // Move i of the undoable part, oldest first (0 <= i < undoCount())
+    Move at(int i) const {
+        return unpackMove(m_buffer[wrap(m_head + i)]);
+    }
+
+private:
+    static const int INITIAL_UNLIMITED_CAPACITY = 64;
+
+    int capacity() const { return (int)m_buffer.size(); }
+
+    int wrap(int i) const {
+        return i >= capacity() ? i - capacity() : i;
+    }
+
+    // Unlimited mode only: double the buffer and unroll it so the head is at 0
+    void grow() {
+        std::vector<PackedMove> bigger(capacity() * 2, 0);
+        for (int i = 0; i < m_size; i++)
+            bigger[i] = m_buffer[wrap(m_head + i)];
+        m_buffer.swap(bigger);
+        m_head = 0;
+    }
+
+    std::vector<PackedMove> m_buffer;
+    int m_depth;
+    int m_head;    // Buffer slot of the oldest move
+    int m_size;    // Moves stored (undoable + redoable)
+    int m_cursor;  // Moves currently applied
+};
+
+#endif /* MOVE_HISTORY_H */
@@ -0,0 +1,87 @@
+/*
+    Minimum-move solver for Marble Solitaire.
+
+    Here a move is a chain of jumps made by one peg: consecutive jumps of
+    the same peg count once, so the English central game takes 18 moves
+    where it takes 31 jumps. solve() finds a shortest line by iterative
+    deepening A* (IDA*): depth-first searches with a growing budget of
+    moves, each cutting a position as soon as the moves played plus a lower
+    bound on the moves still needed exceed the budget. The bound counts the
+    pegs on the board's corner holes (see pruning.h).
+
+    A bound table remembers, per canonical position, the most moves a
+    finished search proved it needs, so transpositions and later iterations
+    start from the learned value instead of the corner count. Positions that
+    cannot reach the goal at all (pagoda and class cuts, or a subtree that
+    ran out of moves) are stored as needing MOVES_UNREACHABLE. Like the dead
+    table of Solver, the bound table survives between calls on the same
+    board and target, so repeated queries along a game get cheaper and a
+    search cut short by a node limit resumes from what it learned.
+*/
+
+#ifndef MOVE_SOLVER_H
+#define MOVE_SOLVER_H
+
+#include <stddef.h>
+#include <vector>
+#include "bitboard.h"
+#include "solver.h"
+
+const int MOVES_UNREACHABLE = 255;
+
+struct MoveSolverStats {
+    uint64_t nodes;       // Positions expanded
+    uint64_t tableHits;   // Positions cut by a bound learned earlier
+    int iterations;       // Budgets searched
+    int bound;            // Last budget, a lower bound on the answer
+    double seconds;
+};
+
+// Lossy map from positions to a small value: here a lower bound on their
+// remaining moves, in FewestPegsSolver their fewest pegs. As in DeadTable,
+// a slot may be overwritten, which only loses what was learned.
+class MoveBoundTable {
+public:
+    explicit MoveBoundTable(int log2Slots = 22);
+
+    void clear();
+    // Learned bound of a position, 0 if none is stored
+    int lookup(uint64_t key, Bitboard pegs) const;
+    void store(uint64_t key, Bitboard pegs, int moves);
+
+private:
+    static const int PROBES = 4;
+
+    std::vector<uint64_t> m_slots;  // Position in the low 56 bits, bound in the top 8; 0 = free
+    uint64_t m_mask;
+};
+
+class MoveSolver {
+public:
+    explicit MoveSolver(int log2TableSlots = 23);
+
+    // Search from pegs for a line with the fewest moves ending with one
+    // peg, on targetHole if it is >= 0. On SOLVE_WIN, line holds the jumps
+    // in order. nodeLimit caps the positions expanded (0 = no limit).
+    SolveResult solve(GeometryId id, Bitboard pegs, std::vector<Move> &line,
+                      int targetHole = -1, uint64_t nodeLimit = 0);
+
+    // Statistics of the last solve() call
+    const MoveSolverStats &stats() const { return m_stats; }
+
+    // Forget all learned bounds
+    void clear();
+
+private:
+    MoveBoundTable m_bounds;
+    Solver m_solver;          // Finds a first line, the upper bound of the search
+    GeometryId m_tableBoard;  // Board and target the bound table was built for
+    int m_tableTarget;
+    MoveSolverStats m_stats;
+};
+
+// Number of moves in a line of jumps: a jump starting where the previous
+// one landed continues its move
+int countChainMoves(const Geometry &geo, const std::vector<Move> &line);
+
+#endif /* MOVE_SOLVER_H */
@@ -0,0 +1,22 @@
+/*
+    Text form of a position, for loading and printing boards in tools.
+
+    A position is written as the rows of the geometry's bounding grid,
+    separated by '/': 'o' is a peg, '_' an empty hole and '.' a cell that
+    is not part of the board. The English start position is
+
+        ..ooo../..ooo../ooooooo/ooo_ooo/ooooooo/..ooo../..ooo..
+*/
+
+#ifndef POSITION_H
+#define POSITION_H
+
+#include <string>
+#include "geometry.h"
+
+// Parse text into pegs; returns false if it does not match the geometry
+bool parsePosition(const Geometry &geo, const char *text, Bitboard &pegs);
+
+std::string formatPosition(const Geometry &geo, Bitboard pegs);
+
+#endif /* POSITION_H */
@@ -0,0 +1,112 @@
+/*
+    Position index: what is known about every position reachable from one
+    start, stored only for those positions.
+
+    Of the 2^N peg patterns of a board only a small share can be reached
+    from a start (23.5 million canonical positions out of 2^33 on the
+    English board), so instead of a table indexed by the peg mask the
+    index keeps a record per reachable canonical position and finds it
+    through a minimal perfect hash: N keys map to the slots 0..N-1 with no
+    collisions and without storing the keys, in under four bits per key.
+
+    The hash is built level by level (as in BBHash): each level hashes the
+    remaining keys into a bit array twice their number, keeps a bit for
+    the keys that landed alone and passes the colliding ones on. A key's
+    slot is the rank of its bit among all the set bits, read from a table
+    of running counts. The few keys left after the last level go to a
+    sorted list that follows the ranked slots.
+
+    A record is 32 bits: a 16-bit fingerprint of the canonical position,
+    which tells a position outside the index apart from the one whose slot
+    it hashes to (all but one in 65536 of them), the fewest pegs it can be
+    reduced to in 6 bits and, in the last 10, the number of jump sequences
+    that take it to a single peg on the goal hole, which is the start's
+    empty hole. Most positions have no such sequence and few have many, so
+    counts that do not fit go to an overflow table of (slot, count) pairs
+    sorted by slot. The English index takes about 5.1 bytes per position.
+    Positions are canonical under the symmetries that fix the goal hole,
+    so the goal and the counts are the same for all of a position's
+    images.
+
+    PositionIndex maps a saved index read-only; a query canonicalizes the
+    position, hashes it and loads its record.
+*/
+
+#ifndef POSITION_INDEX_H
+#define POSITION_INDEX_H
+
+#include <stddef.h>
+#include "bitboard.h"
+#include "mapped_file.h"
+
+const int MAX_INDEX_LEVELS = 24;
+
+// File layout: this header, then, each as 64-bit words, the level bit
+// arrays back to back, the running set-bit counts (one per 8 words of
+// level bits, plus the total) and the sorted keys past the last level;
+// the 32-bit records in slot order and the 32-bit slots of the overflow
+// table, each padded to a multiple of 8 bytes; the overflow counts
+struct PositionIndexHeader {
+    char magic[8];        // "POSIDX2"
+    uint32_t board;       // GeometryId
+    uint32_t startHole;   // Empty hole of the start, also the goal hole
+    uint64_t numKeys;     // Number of positions
+    uint32_t numLevels;
+    uint32_t numFallback; // Keys past the last level
+    uint32_t levelWords[MAX_INDEX_LEVELS]; // Size of each level's bit array in 64-bit words
+    uint64_t numOverflow; // Counts too large for their record
+};
+
+// One position of the index: fingerprint in the top 16 bits, fewest
+// reachable pegs in the next 6, solution count in the low 10
+typedef uint32_t PositionRecord;
+
+struct PositionInfo {
+    int fewestPegs;     // Fewest pegs the position can be reduced to
+    uint64_t solutions; // Winning jump sequences, UINT64_MAX if there are more
+};
+
+class PositionIndex {
+public:
+    PositionIndex();
+
+    // Map an index file; false (with the reason printed) if it cannot
+    // be read or is not an index
+    bool open(const char *path);
+    void close();
+
+    bool isOpen() const { return m_records != NULL; }
+    GeometryId board() const { return (GeometryId)m_header->board; }
+    int startHole() const { return m_header->startHole; }
+    uint64_t size() const { return m_header->numKeys; }
+    size_t fileSize() const { return m_file.size(); }
+
+    // Slot of a canonical position, or -1 when it is not in the index
+    int64_t slot(Bitboard canonical) const;
+
+    // Record of a position; false if it is not reachable from the start
+    bool lookup(Bitboard pegs, PositionInfo &info) const;
+
+private:
+    MappedFile m_file;
+    const PositionIndexHeader *m_header;
+    uint64_t m_levelStart[MAX_INDEX_LEVELS + 1]; // Offset of each level in the bit arrays, in bits
+    uint32_t m_symmetries; // Symmetries fixing the start hole
+    const uint64_t *m_bits;
+    const uint64_t *m_ranks;
+    const uint64_t *m_fallback;
+    const PositionRecord *m_records;
+    const uint32_t *m_overflowSlots;
+    const uint64_t *m_overflowCounts;
+};
+
+// Called after each stage of the build: layer k (positions with k jumps
+// played) found, the hash built (layer -1) and layer k's records filled
+typedef void (*PositionIndexProgress)(const char *stage, int layer, uint64_t positions, void *user);
+
+// Enumerate the positions reachable from the start with emptyHole vacant,
+// build the index and write it to path; false if the file cannot be written
+bool buildPositionIndex(GeometryId id, int emptyHole, const char *path,
+                        PositionIndexProgress progress = NULL, void *user = NULL);
+
+#endif /* POSITION_INDEX_H */
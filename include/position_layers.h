@@ -0,0 +1,154 @@
+/*
+    The positions reachable from a start, in layers, and dynamic
+    programming over them.
+
+    Every jump removes a peg, so the positions reachable from a start fall
+    into layers by the number of jumps played and a position's children all
+    lie in the next layer. enumerate() collects the layers breadth first as
+    canonical positions under a set of symmetries, sorted and without
+    duplicates, leaving out the children a filter rejects. backward() then
+    computes a value for every position from the values of its children,
+    from the last layer back to the start, holding the values of only one
+    layer at a time and finding children through a hash table over the next
+    layer. Both passes split each layer over threads.
+
+    Used by the solution counter and the position index.
+*/
+
+#ifndef POSITION_LAYERS_H
+#define POSITION_LAYERS_H
+
+#include <algorithm>
+#include <vector>
+#include "static_engine.h"
+#include "thread_utils.h"
+#include "zobrist.h"
+
+// Open-addressing map from the positions of a sorted layer to their index
+class LayerTable {
+public:
+    explicit LayerTable(const std::vector<Bitboard> &layer) : m_layer(layer) {
+        size_t size = 16;
+        while (size < 2 * layer.size())
+            size <<= 1;
+        m_slots.assign(size, 0);
+        m_mask = size - 1;
+        for (size_t i = 0; i < layer.size(); i++) {
+            size_t s = splitMix64(layer[i]) & m_mask;
+            while (m_slots[s])
+                s = (s + 1) & m_mask;
+            m_slots[s] = (uint32_t)i + 1;
+        }
+    }
+
+    // Index of a position, or -1 if the layer does not hold it
+    int64_t find(Bitboard pegs) const {
+        for (size_t s = splitMix64(pegs) & m_mask; m_slots[s]; s = (s + 1) & m_mask) {
+            if (m_layer[m_slots[s] - 1] == pegs)
+                return m_slots[s] - 1;
+        }
+        return -1;
+    }
+
+private:
+    const std::vector<Bitboard> &m_layer;
+    std::vector<uint32_t> m_slots;  // Index + 1, 0 = free
+    size_t m_mask;
+};
+
+template <GeometryId G>
+struct PositionLayers {
+    typedef StaticEngine<G> Engine;
+    typedef std::vector<Bitboard> Layer;
+
+    uint32_t symmetries;
+    int threads;
+    std::vector<Layer> layers;  // By jumps played from the start
+
+    PositionLayers(uint32_t symmetries, int threads) : symmetries(symmetries), threads(threads < 1 ? 1 : threads) {}
+
+    // Children of a layer that keep(child) accepts, canonical, sorted and
+    // without duplicates
+    template <class Keep>
+    Layer expand(const Layer &layer, const Keep &keep) const {
+        std::vector<Layer> found(threads);
+        splitRange(threads, layer.size(), [&](size_t begin, size_t end, int t) {
+            Layer &out = found[t];
+            for (size_t i = begin; i < end; i++) {
+                Move moves[MAX_JUMPS];
+                int n = Engine::generateMoves(layer[i], moves);
+                for (int m = 0; m < n; m++) {
+                    Bitboard child = layer[i] ^ Engine::moveMask(moves[m]);
+                    if (keep(child))
+                        out.push_back(Engine::canonical(child, symmetries));
+                }
+            }
+            std::sort(out.begin(), out.end());
+            out.erase(std::unique(out.begin(), out.end()), out.end());
+        });
+
+        // Merge the sorted runs of the threads
+        Layer next;
+        for (size_t t = 0; t < found.size(); t++) {
+            size_t middle = next.size();
+            next.insert(next.end(), found[t].begin(), found[t].end());
+            Layer().swap(found[t]);
+            std::inplace_merge(next.begin(), next.begin() + middle, next.end());
+        }
+        next.erase(std::unique(next.begin(), next.end()), next.end());
+        next.shrink_to_fit();
+        return next;
+    }
+
+    // Layers from start until one is empty; reached(l) is called as soon
+    // as layer l is complete
+    template <class Keep, class Reached>
+    void enumerate(Bitboard start, const Keep &keep, const Reached &reached) {
+        layers.assign(1, Layer(1, Engine::canonical(start, symmetries)));
+        while (true) {
+            reached((int)layers.size() - 1);
+            Layer next = expand(layers.back(), keep);
+            if (next.empty())
+                break;
+            layers.push_back(next);
+        }
+    }
+
+    // Values from the last layer back to the start. leaf(pegs) is a
+    // position's value before its children; add(value, child) adds the value
+    // of each child the next layer holds. done(l, values) is called with the
+    // values of layer l, after which the positions of layer l + 1 are
+    // released. The value of the start is returned.
+    template <class Leaf, class Add, class Done>
+    auto backward(const Leaf &leaf, const Add &add, const Done &done) -> decltype(leaf(Bitboard())) {
+        typedef decltype(leaf(Bitboard())) Value;
+        std::vector<Value> values, nextValues;
+        Layer none;
+        for (int l = (int)layers.size() - 1; l >= 0; l--) {
+            const Layer &layer = layers[l];
+            std::vector<Value>(layer.size()).swap(values);
+            LayerTable table(l + 1 < (int)layers.size() ? layers[l + 1] : none);
+            splitRange(threads, layer.size(), [&](size_t begin, size_t end, int) {
+                for (size_t i = begin; i < end; i++) {
+                    Bitboard pegs = layer[i];
+                    Value value = leaf(pegs);
+                    Move moves[MAX_JUMPS];
+                    int n = Engine::generateMoves(pegs, moves);
+                    for (int m = 0; m < n; m++) {
+                        int64_t child = table.find(Engine::canonical(pegs ^ Engine::moveMask(moves[m]), symmetries));
+                        if (child >= 0)
+                            add(value, nextValues[child]);
+                    }
+                    values[i] = value;
+                }
+            });
+            done(l, values);
+            if (l + 1 < (int)layers.size())
+                Layer().swap(layers[l + 1]);
+            values.swap(nextValues);
+        }
+        return nextValues.empty() ? Value() : nextValues[0];
+    }
+};
+
+#endif /* POSITION_LAYERS_H */
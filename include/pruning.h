@@ -0,0 +1,102 @@
+/*
+    Proofs that a position cannot reach a goal, cheap enough to test at
+    every node of a search.
+
+    A pagoda function gives every hole a weight such that, for every jump,
+    the from- and over-holes weigh at least as much as the landing hole
+    together. The total weight of the pegs then never grows, so a position
+    weighing less than the goal can never reach it. The pagodas tabulated
+    for a board are checked against its jump table at compile time.
+
+    Position classes follow Conway's rule of three: colour the holes with
+    three colours so that every jump touches one hole of each. A jump flips
+    the parity of all three colour counts, so whether any two counts have
+    the same parity never changes. Square boards have two such colourings
+    (the two diagonal directions) and hex boards one, giving 16 or 4
+    classes; positions of different classes never reach each other.
+
+    Corner holes bound the number of moves, counting a chain of jumps by
+    one peg as a single move. A corner is a hole no jump passes over, so a
+    peg on it can only leave by jumping itself, and no single move can take
+    two corner pegs away: each needs a move of its own. On the English
+    board these are the three holes at the end of each arm.
+*/
+
+#ifndef PRUNING_H
+#define PRUNING_H
+
+#include <stddef.h>
+#include <vector>
+#include "bitboard.h"
+
+// Pagoda weights, limited to -1 .. 3 and stored as masks
+struct Pagoda {
+    Bitboard ones;   // Holes of weight 1 or 3
+    Bitboard twos;   // Holes of weight 2 or 3
+    Bitboard minus;  // Holes of weight -1
+};
+
+inline int pagodaValue(const Pagoda &p, Bitboard pegs) {
+    return bbPopCount(pegs & p.ones) + 2 * bbPopCount(pegs & p.twos) - bbPopCount(pegs & p.minus);
+}
+
+// The pagoda functions tabulated for a board together with their images
+// under the board symmetries, without duplicates (none for most boards)
+std::vector<Pagoda> boardPagodas(const Geometry &geo);
+
+// The board's pagodas that can prove a position unable to end with a
+// single peg on the goal, each with its least value on a goal position:
+// those where that value is above the lightest any position can weigh
+struct PagodaCuts {
+    std::vector<Pagoda> pagodas;
+    std::vector<int> least;
+
+    // True if pegs weighs less than every goal position under some pagoda
+    bool below(Bitboard pegs) const {
+        for (size_t k = 0; k < pagodas.size(); k++) {
+            if (pagodaValue(pagodas[k], pegs) < least[k])
+                return true;
+        }
+        return false;
+    }
+};
+
+PagodaCuts goalPagodas(const Geometry &geo, Bitboard goal);
+
+struct PositionClasses {
+    int numColorings;
+    Bitboard color[2][3];  // Holes of each colour, per colouring
+};
+
+PositionClasses positionClasses(const Geometry &geo);
+
+// Class of a position, 0 .. 15; equal for every position reachable from it
+inline int positionClass(const PositionClasses &pc, Bitboard pegs) {
+    int id = 0;
+    for (int k = 0; k < pc.numColorings; k++) {
+        int n0 = bbPopCount(pegs & pc.color[k][0]);
+        int n1 = bbPopCount(pegs & pc.color[k][1]);
+        int n2 = bbPopCount(pegs & pc.color[k][2]);
+        id |= (((n0 + n1) & 1) | ((n1 + n2) & 1) << 1) << (2 * k);
+    }
+    return id;
+}
+
+// Holes of goal that the last peg of a game from pegs can end on: those
+// whose single peg is in the class of pegs
+Bitboard classGoal(const Geometry &geo, Bitboard pegs, Bitboard goal);
+
+// Goal together with the images of its holes under the symmetries in the
+// mask, so that it also holds the canonical image of each single peg on it
+Bitboard symmetricGoal(const Geometry &geo, Bitboard goal, uint32_t symmetries);
+
+// Holes that are never jumped over
+Bitboard cornerHoles(const Geometry &geo);
+
+// Fewest moves, each by a different peg, before none of these pegs is
+// left: one per corner peg
+inline int cornerMoves(Bitboard corners, Bitboard pegs) {
+    return bbPopCount(pegs & corners);
+}
+
+#endif /* PRUNING_H */
@@ -0,0 +1,94 @@
+/*
+    C interface to the Marble Solitaire engine.
+
+    Built into libsolitaire (static and shared) together with the rest of
+    the engine, without any graphics dependencies. A session is one game:
+    a board, its pegs, the legal moves and an undo/redo history. Sessions
+    are independent, so different threads can use different sessions at
+    the same time; a single session must not be used from two threads at
+    once.
+
+    Holes are numbered 0 .. solitaire_hole_count() - 1 row by row, and
+    solitaire_hole_position() maps them back to grid coordinates. Functions
+    returning int report success as 1 and failure as 0 unless noted.
+*/
+
+#ifndef SOLITAIRE_H
+#define SOLITAIRE_H
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define SOLITAIRE_API_VERSION 1
+
+// Upper bound on the legal moves of any position on any board
+#define SOLITAIRE_MAX_MOVES 384
+
+typedef struct SolitaireSession SolitaireSession;
+
+typedef enum {
+    SOLITAIRE_PLAYING = 0,
+    SOLITAIRE_WON = 1,
+    SOLITAIRE_LOST = 2
+} SolitaireStatus;
+
+typedef struct {
+    int from;  // Hole of the jumping peg
+    int over;  // Hole of the captured peg
+    int to;    // Landing hole
+} SolitaireMove;
+
+int solitaire_api_version(void);
+
+// Built-in boards: "english", "european", "wiegleb", "triangular", "hexagonal"
+int solitaire_board_count(void);
+const char *solitaire_board_name(int index);
+
+// New game on the named board (NULL for english) with every hole filled but
+// the default one. undoDepth is the number of undoable moves, 0 = unlimited.
+// Returns NULL for an unknown board or when out of memory.
+SolitaireSession *solitaire_create(const char *board, int undoDepth);
+
+// Independent copy of a session, history included; NULL when out of memory
+SolitaireSession *solitaire_clone(const SolitaireSession *session);
+
+void solitaire_destroy(SolitaireSession *session);
+
+// Restart on the same board with emptyHole vacant (-1 for the default)
+void solitaire_new_game(SolitaireSession *session, int emptyHole);
+
+const char *solitaire_board(const SolitaireSession *session);
+int solitaire_hole_count(const SolitaireSession *session);
+int solitaire_hole_position(const SolitaireSession *session, int hole, int *row, int *col);
+
+int solitaire_peg_count(const SolitaireSession *session);
+int solitaire_has_peg(const SolitaireSession *session, int hole);
+
+// Bit i set when hole i holds a peg
+uint64_t solitaire_pegs(const SolitaireSession *session);
+
+// Zobrist key of the position, maintained incrementally by every move
+uint64_t solitaire_hash(const SolitaireSession *session);
+
+SolitaireStatus solitaire_status(const SolitaireSession *session);
+
+// Write up to capacity legal moves to moves (may be NULL when capacity is 0)
+// and return the total number of legal moves
+int solitaire_legal_moves(const SolitaireSession *session, SolitaireMove *moves, int capacity);
+
+int solitaire_is_legal(const SolitaireSession *session, int from, int to);
+
+// Jump the peg on from to the empty hole to; 0 (and no change) if illegal
+int solitaire_apply_move(SolitaireSession *session, int from, int to);
+
+int solitaire_undo(SolitaireSession *session);
+int solitaire_redo(SolitaireSession *session);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* SOLITAIRE_H */
@@ -0,0 +1,53 @@
+/*
+    Exact count of the winning jump sequences from a position.
+
+    The English central game has about 4 * 10^16 winning sequences, far too
+    many to enumerate, but they run through only a few million distinct
+    positions. Counting is dynamic programming over the position graph: the
+    number of sequences from a position is the sum over its jumps of the
+    number from the resulting position, and a single peg on the goal counts
+    one.
+
+    Every jump removes a peg, so the positions reachable from the start fall
+    into layers by peg count and a position's children all lie in the next
+    layer. A forward pass collects the layers, as canonical positions under
+    the symmetries that keep the goal, leaving out positions a pagoda
+    function proves can no longer reach it. A backward pass then fills the
+    counts from the last layer to the start, holding the counts of only one
+    layer at a time (see position_layers.h).
+
+    Counts are 128-bit and saturate at SOLUTION_COUNT_MAX rather than wrap,
+    so a count of SOLUTION_COUNT_MAX means at least that many.
+*/
+
+#ifndef SOLUTION_COUNT_H
+#define SOLUTION_COUNT_H
+
+#include <string>
+#include "bitboard.h"
+
+typedef unsigned __int128 SolutionCount;
+
+const SolutionCount SOLUTION_COUNT_MAX = ~(SolutionCount)0;
+
+struct SolutionCountStats {
+    uint64_t positions;  // Canonical positions counted, over all layers
+    uint64_t widest;     // Positions of the largest layer
+    int layers;
+    double seconds;
+};
+
+// Called after each layer of either pass: "reached" on the way out,
+// "counted" on the way back, with the layer's peg count and size
+typedef void (*SolutionCountProgress)(const char *stage, int pegs, uint64_t positions, void *user);
+
+// Number of jump sequences that take pegs to a single peg, on targetHole if
+// it is >= 0 and on any hole otherwise
+SolutionCount countSolutions(GeometryId id, Bitboard pegs, int targetHole = -1, int threads = 1,
+                             SolutionCountStats *stats = NULL, SolutionCountProgress progress = NULL,
+                             void *user = NULL);
+
+// Decimal digits of a count
+std::string formatSolutionCount(SolutionCount count);
+
+#endif /* SOLUTION_COUNT_H */
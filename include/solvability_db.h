@@ -0,0 +1,67 @@
+/*
+    Solvability database: one bit per position of a board, set when the
+    position can still be reduced to a single peg (on any hole).
+
+    buildSolvabilityDb() fills the bits by retrograde analysis, one layer
+    of peg count at a time: a single peg has already won, and a position
+    with k pegs is winnable when one of its jumps leads to a winnable
+    position with k - 1 pegs. The table is indexed by the peg mask itself,
+    so an N-hole board takes 2^N bits (1 GiB for the English board) and
+    only boards of up to MAX_DB_HOLES holes are supported.
+
+    SolvabilityDb maps a saved table read-only, so opening it costs
+    nothing up front and every query is a bit test, with no search.
+*/
+
+#ifndef SOLVABILITY_DB_H
+#define SOLVABILITY_DB_H
+
+#include <stddef.h>
+#include "bitboard.h"
+#include "mapped_file.h"
+
+const int MAX_DB_HOLES = 34;
+
+// File layout: this header, then the 2^numHoles bits as 64-bit words
+struct SolvabilityDbHeader {
+    char magic[8];        // "SOLVDB1"
+    uint32_t board;       // GeometryId
+    uint32_t numHoles;
+    uint64_t winnable;    // Number of positions with their bit set
+    uint8_t reserved[40]; // Pads the header to 64 bytes
+};
+
+class SolvabilityDb {
+public:
+    SolvabilityDb();
+
+    // Map a database file; false (with the reason printed) if it cannot
+    // be read or is not a database
+    bool open(const char *path);
+    void close();
+
+    bool isOpen() const { return m_bits != NULL; }
+    GeometryId board() const { return (GeometryId)m_header->board; }
+    uint64_t winnableCount() const { return m_header->winnable; }
+
+    bool winnable(Bitboard pegs) const { return (m_bits[pegs >> 6] >> (pegs & 63)) & 1; }
+
+    // The legal moves of a position that keep it winnable; returns their number
+    int winningMoves(Bitboard pegs, Move *moves) const;
+
+private:
+    MappedFile m_file;
+    const SolvabilityDbHeader *m_header;
+    const uint64_t *m_bits;
+};
+
+// Called after each layer of the build with the layer's peg count and the
+// number of its positions found winnable
+typedef void (*SolvabilityDbProgress)(int pegs, uint64_t winnable, void *user);
+
+// Build the database of a board on the given number of threads and write
+// it to path; false if the board is too large or the file cannot be written
+bool buildSolvabilityDb(GeometryId id, const char *path, int threads,
+                        SolvabilityDbProgress progress = NULL, void *user = NULL);
+
+#endif /* SOLVABILITY_DB_H */
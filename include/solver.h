@@ -0,0 +1,142 @@
+/*
+    Depth-first solver for Marble Solitaire.
+
+    solve() searches for a sequence of jumps that leaves a single peg
+    (optionally on a given hole) using the specialized engine's move
+    generator. Positions whose whole subtree has been searched without
+    success are remembered in a dead-position table. The table stores the
+    canonical form of each position (its smallest image under the board
+    symmetries that preserve the goal), so a position and its symmetric
+    twins are expanded at most once between them. The table belongs to the
+    Solver and survives between calls on the same board and target, which makes
+    repeated queries along a game (hints) nearly free. It can also be saved
+    to a file and loaded again, so that the next session starts with what
+    this one learned.
+
+    With more than one thread, the first plies are expanded as shared tasks
+    on a work-stealing pool: each worker keeps its own deque, works on its
+    newest task and steals the oldest task of another worker when it runs
+    dry. Below the split plies each task is an ordinary depth-first search.
+    All workers share the dead table, whose slots are atomic; a position
+    whose tasks have all failed is entered there by the worker that
+    finishes the last one.
+
+    Hopeless positions are also cut without search (see pruning.h): a start
+    whose position class cannot reach the goal fails at once, and the goal
+    is narrowed to the holes of the start's class; a position weighing less
+    than the goal under a pagoda function is dead.
+*/
+
+#ifndef SOLVER_H
+#define SOLVER_H
+
+#include <stddef.h>
+#include <atomic>
+#include <vector>
+#include "bitboard.h"
+#include "zobrist.h"
+
+enum SolveResult {
+    SOLVE_WIN = 0,      // Winning line found
+    SOLVE_DEAD = 1,     // Proven that no line reaches the goal
+    SOLVE_UNKNOWN = 2   // Node limit reached first
+};
+
+// Pruning rules, combined as bit flags
+enum SolverPruning {
+    PRUNE_NONE = 0,
+    PRUNE_PAGODAS = 1,  // Pagoda function bounds at every node
+    PRUNE_CLASSES = 2,  // Position classes (rule of three) at the start
+    PRUNE_ALL = 3
+};
+
+struct SolverStats {
+    uint64_t nodes;        // Positions expanded
+    uint64_t deadHits;     // Positions cut by the dead table
+    uint64_t pagodaCuts;   // Positions cut by a pagoda bound
+    double seconds;
+    std::vector<uint64_t> threadNodes;  // Positions expanded by each worker
+};
+
+// Lossy set of dead positions: a slot is overwritten when all the slots a
+// key may probe are taken, which only costs search time, never correctness.
+// Safe to use from several threads: two inserts racing for a slot just
+// lose one of the entries.
+class DeadTable {
+public:
+    explicit DeadTable(int log2Slots = 22);
+
+    void clear();
+    bool contains(ZobristKey key, Bitboard pegs) const;
+    void insert(ZobristKey key, Bitboard pegs);
+
+    // Occupied slots (counted on demand)
+    size_t size() const;
+    size_t capacity() const { return m_slots.size(); }
+
+    // Raw slot access, for saving and loading the table
+    Bitboard slot(size_t i) const { return m_slots[i].load(std::memory_order_relaxed); }
+    void setSlot(size_t i, Bitboard pegs) { m_slots[i].store(pegs, std::memory_order_relaxed); }
+
+private:
+    static const int PROBES = 4;
+
+    std::vector<std::atomic<Bitboard> > m_slots;  // Peg masks, 0 = free (never a searched position)
+    uint64_t m_mask;
+};
+
+// Header of a saved dead table, followed by its slots
+struct DeadTableHeader {
+    char magic[8];        // "DEADTB1"
+    uint32_t board;       // GeometryId
+    int32_t target;       // Target hole, -1 for any
+    uint32_t log2Slots;
+    uint32_t numHoles;
+    uint64_t entries;     // Occupied slots
+    uint64_t checksum;    // Over the slots, see tableChecksum() in solver.cpp
+    uint8_t reserved[24]; // Pads the header to 64 bytes
+};
+
+class Solver {
+public:
+    explicit Solver(int log2TableSlots = 22);
+
+    // Search from pegs for a line of jumps ending with one peg, on
+    // targetHole if it is >= 0. On SOLVE_WIN, line holds the moves in
+    // order. nodeLimit caps the positions expanded (0 = no limit).
+    SolveResult solve(GeometryId id, Bitboard pegs, std::vector<Move> &line,
+                      int targetHole = -1, uint64_t nodeLimit = 0);
+
+    // Statistics of the last solve() call
+    const SolverStats &stats() const { return m_stats; }
+
+    // Worker threads for later solve() calls, 1 (the caller only) by default
+    void setThreads(int threads) { m_threads = threads < 1 ? 1 : threads; }
+    int threads() const { return m_threads; }
+
+    // Pruning rules to apply, PRUNE_ALL by default. They only cut positions
+    // that are dead anyway, so the dead table stays valid across changes.
+    void setPruning(int flags) { m_pruning = flags; }
+    int pruning() const { return m_pruning; }
+
+    // Forget all dead positions
+    void clear();
+
+    // Write the dead table, with the board and target it belongs to, to path
+    bool saveTable(const char *path) const;
+
+    // Replace the dead table with one written by saveTable(). The file is
+    // mapped and copied in whole; it must have as many slots as this
+    // solver's table. False (quietly if the file does not exist) otherwise.
+    bool loadTable(const char *path);
+
+private:
+    DeadTable m_dead;
+    GeometryId m_tableBoard;  // Board and target the dead table was built for
+    int m_tableTarget;
+    int m_pruning;
+    int m_threads;
+    SolverStats m_stats;
+};
+
+#endif /* SOLVER_H */
@@ -0,0 +1,159 @@
+/*
+    Background worker for the game's searches.
+
+    The searches behind hints, the moves-left and best-possible counters
+    and automatic play take from milliseconds to seconds, too long for the
+    render loop. The GUI posts them as jobs to a SolverWorker, which runs
+    them on its own thread, and polls for their results once per frame.
+
+    Jobs go in and results come out through single-producer,
+    single-consumer rings (the GUI thread is the only producer of jobs and
+    the only consumer of results), so neither side ever waits for a lock.
+    The worker keeps at most one job of each kind and runs the active ones
+    in turns, one slice of a bounded number of nodes (or milliseconds for
+    MCTS) at a time. The solvers keep what a slice learned in their tables,
+    so the slices add up to one search.
+
+    Every job carries the board generation it was posted in. cancel()
+    starts a new generation: the worker drops older jobs at its next slice
+    boundary, and poll() discards any result of an older generation that
+    was already on its way. The nodes searched by the current jobs and the
+    search speed are published through atomics for the progress panel.
+
+    Given a cache directory, the worker keeps the hint solver's dead table
+    of each board in BOARD.cache there: loaded when hints on the board are
+    first asked for, saved when hints move to another board and when the
+    worker shuts down. Openings analysed in one session are then answered
+    from the table in the next.
+*/
+
+#ifndef SOLVER_WORKER_H
+#define SOLVER_WORKER_H
+
+#include <atomic>
+#include <string>
+#include <thread>
+#include <vector>
+#include "bitboard.h"
+#include "solver.h"
+
+/* ################################################################# */
+// Lock-free ring //
+
+// Fixed-capacity queue for one producer thread and one consumer thread.
+// Each side owns the slots between its index and the other's, and an
+// index is published with release order once its slot is written or read.
+template <class T, size_t CAPACITY>
+class SpscRing {
+public:
+    SpscRing() : m_head(0), m_tail(0) {}
+
+    // Producer side; false if the ring is full
+    bool push(const T &item) {
+        size_t head = m_head.load(std::memory_order_relaxed);
+        if (head - m_tail.load(std::memory_order_acquire) == CAPACITY)
+            return false;
+        m_slots[head % CAPACITY] = item;
+        m_head.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Consumer side; false if the ring is empty
+    bool pop(T &item) {
+        size_t tail = m_tail.load(std::memory_order_relaxed);
+        if (tail == m_head.load(std::memory_order_acquire))
+            return false;
+        item = m_slots[tail % CAPACITY];
+        m_tail.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+private:
+    T m_slots[CAPACITY];
+    std::atomic<size_t> m_head;  // Next slot to write, advanced by the producer
+    std::atomic<size_t> m_tail;  // Next slot to read, advanced by the consumer
+};
+
+/* ################################################################# */
+// Jobs //
+
+enum SolverJobKind {
+    JOB_HINT = 0,         // A winning line, for its first jump
+    JOB_MOVES_LEFT = 1,   // Fewest moves to a single peg
+    JOB_FEWEST_PEGS = 2,  // Fewest pegs the position can be reduced to
+    JOB_MCTS = 3,         // Monte Carlo tree search decision
+    NUM_SOLVER_JOBS = 4
+};
+
+struct SolverJob {
+    SolverJobKind kind;
+    GeometryId board;
+    Bitboard pegs;
+    double seconds;  // Search time of a JOB_MCTS decision
+    int threads;     // Threads of a JOB_MCTS search
+};
+
+// Final result of a job, or (final = false) a partial one for the
+// counters: a lower bound on the moves left, the fewest pegs found so far
+struct SolverJobResult {
+    SolverJobKind kind;
+    uint64_t generation;
+    bool final;
+    SolveResult result;      // SOLVE_WIN or SOLVE_DEAD once final
+    int value;               // Moves left, fewest pegs, pegs left by the MCTS line
+    std::vector<Move> line;  // Winning line, best line or MCTS line
+};
+
+struct SolverProgress {
+    unsigned jobs;          // Bit k set while a job of kind k is active
+    uint64_t nodes;         // Nodes (playouts for MCTS) of the active jobs so far
+    double nodesPerSecond;  // Over the last slices
+};
+
+class SolverWorker {
+public:
+    // cacheDir: where the hint tables are kept, NULL for no cache
+    explicit SolverWorker(const char *cacheDir = NULL);
+    ~SolverWorker();
+
+    // Queue a job for the current generation; it replaces an active job
+    // of the same kind. False if the job queue is full.
+    bool post(const SolverJob &job);
+
+    // Drop every job posted so far, running or queued
+    void cancel();
+
+    // Next result of the current generation; false if there is none
+    bool poll(SolverJobResult &result);
+
+    uint64_t generation() const { return m_generation.load(std::memory_order_relaxed); }
+    SolverProgress progress() const;
+
+private:
+    SolverWorker(const SolverWorker &);
+    SolverWorker &operator=(const SolverWorker &);
+
+    struct PostedJob {
+        SolverJob job;
+        uint64_t generation;
+    };
+    struct ActiveJob;
+    struct Solvers;
+
+    void run();
+    uint64_t runSlice(ActiveJob &active, Solvers &solvers);
+    void switchHintTable(Solvers &solvers, GeometryId board);
+    void saveHintTable(Solvers &solvers);
+
+    SpscRing<PostedJob, 16> m_jobs;
+    SpscRing<SolverJobResult, 64> m_results;
+    std::atomic<uint64_t> m_generation;
+    std::atomic<bool> m_quit;
+    std::atomic<unsigned> m_activeJobs;
+    std::atomic<uint64_t> m_nodes;
+    std::atomic<double> m_nodesPerSecond;
+    std::string m_cacheDir;  // Empty for no cache
+    std::thread m_thread;
+};
+
+#endif /* SOLVER_WORKER_H */
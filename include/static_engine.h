@@ -0,0 +1,352 @@
+/*
+    Geometry-specialized engine.
+
+    StaticEngine<G> is the bitboard engine instantiated for one board. The
+    geometry tables are constexpr, so every jump is folded into a handful of
+    shift-and-mask groups (jumps whose over and landing holes sit at the same
+    index offsets from the from-hole) and every symmetry into shift-and-mask
+    steps (holes that move by the same index offset). Move generation, the
+    game-over test, the symmetry transforms and canonicalization (the
+    smallest of a position's symmetric images) are then fully unrolled
+    straight-line code with constant shifts and masks, with no geometry
+    lookups in the inner loop.
+
+    Code that only knows the board at runtime goes through getEngineOps()
+    or dispatchGeometry(), which pick the right instantiation once.
+*/
+
+#ifndef STATIC_ENGINE_H
+#define STATIC_ENGINE_H
+
+#include <stddef.h>
+#include <array>
+#include <utility>
+#include "bitboard.h"
+#include "geometry_tables.h"
+
+// Jumps sharing the same hole-index offsets, tested together on a whole mask
+struct JumpGroup {
+    Bitboard from;  // From-holes of the jumps in this group
+    int overShift;  // over - from
+    int toShift;    // to - from
+    int dir;
+};
+
+// Holes that a symmetry moves by the same index offset
+struct PermutationStep {
+    Bitboard mask;
+    int shift;  // image - hole
+};
+
+/* ################################################################# */
+// Compile-time table construction //
+
+constexpr int findJumpGroup(const JumpGroup *groups, int count, const Jump &j) {
+    for (int g = 0; g < count; g++) {
+        if (groups[g].dir == j.dir && groups[g].overShift == j.over - j.from &&
+            groups[g].toShift == j.to - j.from)
+            return g;
+    }
+    return -1;
+}
+
+// Group the jump table; returns the number of groups written to groups[]
+constexpr int collectJumpGroups(const Geometry &geo, JumpGroup *groups) {
+    int count = 0;
+    for (int i = 0; i < geo.numJumps; i++) {
+        const Jump &j = geo.jumps[i];
+        int g = findJumpGroup(groups, count, j);
+        if (g < 0) {
+            g = count++;
+            groups[g].from = 0;
+            groups[g].overShift = j.over - j.from;
+            groups[g].toShift = j.to - j.from;
+            groups[g].dir = j.dir;
+        }
+        groups[g].from |= (Bitboard)1 << j.from;
+    }
+    return count;
+}
+
+constexpr int countJumpGroups(const Geometry &geo) {
+    JumpGroup groups[MAX_JUMPS] = {};
+    return collectJumpGroups(geo, groups);
+}
+
+template <int N>
+constexpr std::array<JumpGroup, N> buildJumpGroups(const Geometry &geo) {
+    JumpGroup groups[MAX_JUMPS] = {};
+    collectJumpGroups(geo, groups);
+    std::array<JumpGroup, N> out = {};
+    for (int g = 0; g < N; g++)
+        out[g] = groups[g];
+    return out;
+}
+
+// Split symmetry s into steps; returns the number of steps written to steps[]
+constexpr int collectPermutationSteps(const Geometry &geo, int s, PermutationStep *steps) {
+    int count = 0;
+    for (int h = 0; h < geo.numHoles; h++) {
+        int shift = geo.symmetry[s][h] - h;
+        int k = 0;
+        while (k < count && steps[k].shift != shift)
+            k++;
+        if (k == count) {
+            steps[count].mask = 0;
+            steps[count].shift = shift;
+            count++;
+        }
+        steps[k].mask |= (Bitboard)1 << h;
+    }
+    return count;
+}
+
+constexpr int countPermutationSteps(const Geometry &geo, int s) {
+    PermutationStep steps[MAX_HOLES] = {};
+    return collectPermutationSteps(geo, s, steps);
+}
+
+template <int N>
+constexpr std::array<PermutationStep, N> buildPermutationSteps(const Geometry &geo, int s) {
+    PermutationStep steps[MAX_HOLES] = {};
+    collectPermutationSteps(geo, s, steps);
+    std::array<PermutationStep, N> out = {};
+    for (int k = 0; k < N; k++)
+        out[k] = steps[k];
+    return out;
+}
+
+// Image under symmetry s of every value of input byte b: the OR of the
+// entries picked by a position's bytes is the position's image
+template <int NumBytes>
+constexpr std::array<std::array<Bitboard, 256>, NumBytes> buildByteImages(const Geometry &geo, int s) {
+    std::array<std::array<Bitboard, 256>, NumBytes> out = {};
+    for (int b = 0; b < NumBytes; b++) {
+        for (int v = 0; v < 256; v++) {
+            Bitboard image = 0;
+            for (int k = 0; k < 8; k++) {
+                int hole = b * 8 + k;
+                if (((v >> k) & 1) && hole < geo.numHoles)
+                    image |= (Bitboard)1 << geo.symmetry[s][hole];
+            }
+            out[b][v] = image;
+        }
+    }
+    return out;
+}
+
+// Bit i of the result is bit (i + Delta) of bb
+template <int Delta>
+inline Bitboard shiftFrom(Bitboard bb) {
+    if constexpr (Delta >= 0)
+        return bb >> Delta;
+    else
+        return bb << -Delta;
+}
+
+/* ################################################################# */
+// The engine //
+
+template <GeometryId G>
+struct StaticEngine {
+    static constexpr const Geometry &geo = GEOMETRY_TABLE[G];
+    static constexpr int NUM_HOLES = geo.numHoles;
+    static constexpr int NUM_SYMMETRIES = geo.numSymmetries;
+    static constexpr Bitboard HOLES = geo.allHoles;
+
+    static constexpr int NUM_GROUPS = countJumpGroups(geo);
+    static constexpr std::array<JumpGroup, NUM_GROUPS> GROUPS = buildJumpGroups<NUM_GROUPS>(geo);
+
+    // Pegs that can make the jumps of group I
+    template <int I>
+    static inline Bitboard groupSources(Bitboard pegs) {
+        constexpr JumpGroup g = GROUPS[I];
+        return g.from & pegs & shiftFrom<g.overShift>(pegs) & ~shiftFrom<g.toShift>(pegs);
+    }
+
+    template <size_t... I>
+    static inline Bitboard anySources(Bitboard pegs, std::index_sequence<I...>) {
+        return (groupSources<I>(pegs) | ...);
+    }
+
+    template <size_t... I>
+    static inline int countSources(Bitboard pegs, std::index_sequence<I...>) {
+        return (bbPopCount(groupSources<I>(pegs)) + ...);
+    }
+
+    template <int I>
+    static inline void appendGroup(Bitboard pegs, Move *moves, int &count) {
+        Bitboard sources = groupSources<I>(pegs);
+        while (sources) {
+            moves[count].from = (uint8_t)bbLowest(sources);
+            moves[count].dir = (uint8_t)GROUPS[I].dir;
+            count++;
+            sources &= sources - 1;
+        }
+    }
+
+    template <size_t... I>
+    static inline void appendAll(Bitboard pegs, Move *moves, int &count, std::index_sequence<I...>) {
+        (appendGroup<I>(pegs, moves, count), ...);
+    }
+
+    static inline bool hasAnyMove(Bitboard pegs) {
+        return anySources(pegs, std::make_index_sequence<NUM_GROUPS>()) != 0;
+    }
+
+    // No jump left anywhere on the board
+    static inline bool isGameOver(Bitboard pegs) {
+        return !hasAnyMove(pegs);
+    }
+
+    static inline int countMoves(Bitboard pegs) {
+        return countSources(pegs, std::make_index_sequence<NUM_GROUPS>());
+    }
+
+    // Fill moves[] (room for geo.numJumps entries) and return how many were written
+    static inline int generateMoves(Bitboard pegs, Move *moves) {
+        int count = 0;
+        appendAll(pegs, moves, count, std::make_index_sequence<NUM_GROUPS>());
+        return count;
+    }
+
+    static inline Bitboard moveMask(Move m) {
+        return geo.jumps[geo.jumpIndex[m.from][m.dir]].mask;
+    }
+
+    static inline void applyMove(Bitboard &pegs, Move m) { pegs ^= moveMask(m); }
+    static inline void revertMove(Bitboard &pegs, Move m) { pegs ^= moveMask(m); }
+
+    /* ############################################################# */
+    // Symmetries //
+
+    template <int S>
+    struct Symmetry {
+        static constexpr int NUM_STEPS = countPermutationSteps(geo, S);
+        static constexpr std::array<PermutationStep, NUM_STEPS> STEPS =
+            buildPermutationSteps<NUM_STEPS>(geo, S);
+
+        // Rotations scatter holes over many offsets; past one step per
+        // byte, a lookup per byte of the position is cheaper
+        static constexpr int NUM_BYTES = (NUM_HOLES + 7) / 8;
+        static constexpr bool USE_BYTES = NUM_STEPS > 2 * NUM_BYTES;
+        static constexpr std::array<std::array<Bitboard, 256>, USE_BYTES ? NUM_BYTES : 0> BYTES =
+            buildByteImages<USE_BYTES ? NUM_BYTES : 0>(geo, S);
+
+        template <int K>
+        static inline Bitboard step(Bitboard pegs) {
+            constexpr PermutationStep st = STEPS[K];
+            return shiftFrom<-st.shift>(pegs & st.mask);
+        }
+
+        template <size_t... K>
+        static inline Bitboard applyAll(Bitboard pegs, std::index_sequence<K...>) {
+            return (step<K>(pegs) | ...);
+        }
+
+        template <size_t... B>
+        static inline Bitboard lookupAll(Bitboard pegs, std::index_sequence<B...>) {
+            return (BYTES[B][(pegs >> (8 * B)) & 0xFF] | ... | 0);
+        }
+
+        static Bitboard apply(Bitboard pegs) {
+            if constexpr (USE_BYTES)
+                return lookupAll(pegs, std::make_index_sequence<NUM_BYTES>());
+            else
+                return applyAll(pegs, std::make_index_sequence<NUM_STEPS>());
+        }
+    };
+
+    // Image of a position under symmetry S (see Geometry::symmetry)
+    template <int S>
+    static inline Bitboard transform(Bitboard pegs) {
+        return Symmetry<S>::apply(pegs);
+    }
+
+    typedef Bitboard (*TransformFn)(Bitboard);
+
+    template <size_t... S>
+    static constexpr std::array<TransformFn, NUM_SYMMETRIES> transformTable(std::index_sequence<S...>) {
+        return {{ &Symmetry<S>::apply... }};
+    }
+
+    static inline Bitboard transform(Bitboard pegs, int s) {
+        static constexpr std::array<TransformFn, NUM_SYMMETRIES> table =
+            transformTable(std::make_index_sequence<NUM_SYMMETRIES>());
+        return table[s](pegs);
+    }
+
+    template <int S>
+    static inline void keepSmaller(Bitboard pegs, uint32_t symmetries, Bitboard &best) {
+        if ((symmetries >> S) & 1) {
+            Bitboard image = Symmetry<S>::apply(pegs);
+            best = image < best ? image : best;
+        }
+    }
+
+    template <size_t... S>
+    static inline Bitboard minImage(Bitboard pegs, uint32_t symmetries, std::index_sequence<S...>) {
+        Bitboard best = pegs;
+        (keepSmaller<S>(pegs, symmetries, best), ...);
+        return best;
+    }
+
+    // Smallest image of a position under the board's symmetries: positions
+    // that are symmetric to each other share it, so it serves as their key
+    static inline Bitboard canonical(Bitboard pegs) {
+        return minImage(pegs, ~0u, std::make_index_sequence<NUM_SYMMETRIES>());
+    }
+
+    // Same over a subgroup, bit s of symmetries selecting symmetry s
+    static inline Bitboard canonical(Bitboard pegs, uint32_t symmetries) {
+        return minImage(pegs, symmetries, std::make_index_sequence<NUM_SYMMETRIES>());
+    }
+};
+
+// Symmetries (as a bit set) that map hole to itself; these are the ones
+// that keep a goal such as "finish on hole" unchanged
+inline uint32_t symmetriesFixing(const Geometry &geo, int hole) {
+    uint32_t fixing = 0;
+    for (int s = 0; s < geo.numSymmetries; s++) {
+        if (geo.symmetry[s][hole] == hole)
+            fixing |= 1u << s;
+    }
+    return fixing;
+}
+
+inline uint32_t allSymmetries(const Geometry &geo) {
+    return (1u << geo.numSymmetries) - 1;
+}
+
+/* ################################################################# */
+// Runtime dispatch //
+
+// Function table of one StaticEngine instantiation, for code that picks the
+// board at runtime (the GUI) and wants to pay for the choice only once.
+struct EngineOps {
+    GeometryId id;
+    bool (*hasAnyMove)(Bitboard pegs);
+    int (*countMoves)(Bitboard pegs);
+    int (*generateMoves)(Bitboard pegs, Move *moves);
+    Bitboard (*transform)(Bitboard pegs, int symmetry);
+    Bitboard (*canonical)(Bitboard pegs);
+    Bitboard (*canonicalUnder)(Bitboard pegs, uint32_t symmetries);
+};
+
+const EngineOps &getEngineOps(GeometryId id);
+
+// Call Fn<G>::run(args...) for the geometry chosen at runtime. Whole
+// algorithms (solvers, benchmarks) are written as templates on G and
+// instantiated once per board through this switch.
+template <template <GeometryId> class Fn, class... Args>
+auto dispatchGeometry(GeometryId id, Args &&... args) {
+    switch (id) {
+    case GEOMETRY_EUROPEAN:   return Fn<GEOMETRY_EUROPEAN>::run(std::forward<Args>(args)...);
+    case GEOMETRY_WIEGLEB:    return Fn<GEOMETRY_WIEGLEB>::run(std::forward<Args>(args)...);
+    case GEOMETRY_TRIANGULAR: return Fn<GEOMETRY_TRIANGULAR>::run(std::forward<Args>(args)...);
+    case GEOMETRY_HEXAGONAL:  return Fn<GEOMETRY_HEXAGONAL>::run(std::forward<Args>(args)...);
+    default:                  return Fn<GEOMETRY_ENGLISH>::run(std::forward<Args>(args)...);
+    }
+}
+
+#endif /* STATIC_ENGINE_H */
@@ -0,0 +1,33 @@
+/*
+    Spreading work over threads. The calling thread always takes part as
+    thread 0, so a single thread never starts another.
+*/
+
+#ifndef THREAD_UTILS_H
+#define THREAD_UTILS_H
+
+#include <stddef.h>
+#include <thread>
+#include <vector>
+
+// Run work(thread) for every thread from 0 to threads - 1
+template <class Work>
+inline void runThreads(int threads, const Work &work) {
+    std::vector<std::thread> workers;
+    for (int t = 1; t < threads; t++)
+        workers.push_back(std::thread(work, t));
+    work(0);
+    for (size_t t = 0; t < workers.size(); t++)
+        workers[t].join();
+}
+
+// Run work(begin, end, thread) over [0, count) split into one range per
+// thread; a small count stays on the calling thread
+template <class Work>
+inline void splitRange(int threads, size_t count, const Work &work) {
+    if (threads < 1 || count < 1024)
+        threads = 1;
+    runThreads(threads, [&](int t) { work(count * t / threads, count * (t + 1) / threads, t); });
+}
+
+#endif /* THREAD_UTILS_H */
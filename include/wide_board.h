@@ -0,0 +1,153 @@
+/*
+    Wide-bitset engine for large square-lattice boards (up to 256x256 holes).
+
+    Every row of the board is a 256-bit bitset stored as four 64-bit words,
+    with two all-zero guard rows above and below the board. Horizontal jumps
+    are found with multi-word shifts inside a row and vertical jumps by
+    combining neighbouring rows, so a full move generation is a few vector
+    operations per row. The row kernel is picked at runtime: AVX2 (one row
+    per register), SSE2 (two registers per row) or portable scalar code.
+*/
+
+#ifndef WIDE_BOARD_H
+#define WIDE_BOARD_H
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+#include "zobrist.h"
+
+const int WIDE_MAX_SIZE = 256;
+const int WIDE_ROW_WORDS = WIDE_MAX_SIZE / 64;
+const int WIDE_GUARD_ROWS = 2;
+const int WIDE_DIRECTIONS = 4;  // DIR_UP, DIR_DOWN, DIR_LEFT, DIR_RIGHT as in geometry.h
+
+enum WideKernel { WIDE_KERNEL_SCALAR = 0, WIDE_KERNEL_SSE2 = 1, WIDE_KERNEL_AVX2 = 2 };
+
+struct WideMove {
+    uint8_t row;  // Row of the jumping peg
+    uint8_t col;  // Column of the jumping peg
+    uint8_t dir;  // Direction
+};
+
+// One bitset per direction marking the pegs that can jump that way, in the
+// same padded row layout as the board
+struct WideSources {
+    std::vector<uint64_t> dir[WIDE_DIRECTIONS];
+};
+
+class WideBoard {
+public:
+    WideBoard();
+
+    // A width x height rectangle of holes, all empty
+    WideBoard(int width, int height);
+
+    // Parse a layout, one line per row: 'o' is a peg, '_' an empty hole and
+    // '.' (or anything else) not part of the board. Returns false if the
+    // layout is empty or larger than WIDE_MAX_SIZE in either direction.
+    bool parse(const std::vector<std::string> &lines);
+
+    // A scaled-up English cross: a size x size square without its corners,
+    // arms armWidth holes wide, filled except for the central hole
+    static WideBoard cross(int size, int armWidth);
+
+    int width() const { return m_width; }
+    int height() const { return m_height; }
+    int holeCount() const { return m_holeCount; }
+    int pegCount() const { return m_pegCount; }
+
+    // 128-bit Zobrist key of the pegs, kept up to date by every change
+    ZobristKey128 hash() const { return m_hash; }
+
+    bool isHole(int row, int col) const { return testBit(m_holes, row, col); }
+    bool hasPeg(int row, int col) const { return testBit(m_pegs, row, col); }
+    void setHole(int row, int col, bool hole);
+    void setPeg(int row, int col, bool peg);
+
+    // Fill every hole except (row, col)
+    void fillAllBut(int row, int col);
+
+    // Sources for rows [rowBegin, rowEnd) with the active kernel; out must
+    // come from allocSources() and keeps its other rows untouched
+    void computeSources(WideSources &out, int rowBegin, int rowEnd) const;
+    void allocSources(WideSources &out) const;
+
+    bool hasAnyMove() const;
+    int countMoves() const;
+    void generateMoves(std::vector<WideMove> &moves) const;
+
+    bool isLegal(WideMove m) const;
+    void applyMove(WideMove m);
+    void revertMove(WideMove m);
+
+    // Landing cell of a move
+    static int targetRow(WideMove m);
+    static int targetCol(WideMove m);
+
+    std::string toString() const;
+
+    // Raw padded rows, row r at words [(r + WIDE_GUARD_ROWS) * WIDE_ROW_WORDS, +WIDE_ROW_WORDS)
+    const uint64_t *holeWords() const { return &m_holes[0]; }
+    const uint64_t *pegWords() const { return &m_pegs[0]; }
+    int paddedWords() const { return (int)m_pegs.size(); }
+
+private:
+    static int wordIndex(int row, int col) {
+        return (row + WIDE_GUARD_ROWS) * WIDE_ROW_WORDS + (col >> 6);
+    }
+    static bool testBit(const std::vector<uint64_t> &bits, int row, int col) {
+        return (bits[wordIndex(row, col)] >> (col & 63)) & 1;
+    }
+    void toggle(int row, int col) {
+        m_pegs[wordIndex(row, col)] ^= (uint64_t)1 << (col & 63);
+        m_hash ^= zobristCell128(row, col);
+    }
+    void reset(int width, int height);
+
+    int m_width, m_height;
+    int m_holeCount, m_pegCount;
+    ZobristKey128 m_hash;
+    std::vector<uint64_t> m_holes;
+    std::vector<uint64_t> m_pegs;
+};
+
+/* ################################################################# */
+// Incremental legal-move tracking on wide boards //
+
+// Live move set for a WideBoard. A jump only changes the legality of jumps
+// within two cells of its three holes, so after each move only the rows
+// from two above to two below the jump are recomputed, and a running move
+// count makes the game-over test O(1).
+class WideMoveSet {
+public:
+    WideMoveSet() : m_count(0) {}
+
+    void init(const WideBoard &board);
+    void update(const WideBoard &board, WideMove m);
+
+    bool empty() const { return m_count == 0; }
+    int count() const { return m_count; }
+    bool contains(WideMove m) const;
+    const WideSources &sources() const { return m_sources; }
+
+private:
+    int rowCount(int row) const;
+
+    WideSources m_sources;
+    int m_count;
+};
+
+/* ################################################################# */
+// Kernel selection //
+
+// Best kernel supported by this CPU
+WideKernel wideBestKernel();
+
+// Use a specific kernel; returns false (and changes nothing) if unsupported
+bool wideSelectKernel(WideKernel kernel);
+
+WideKernel wideActiveKernel();
+const char *wideKernelName(WideKernel kernel);
+
+#endif /* WIDE_BOARD_H */
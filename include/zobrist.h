@@ -0,0 +1,84 @@
+/*
+    Zobrist position keys.
+
+    Every hole has a fixed random key and a position's hash is the XOR of
+    the keys of the holes holding a peg, plus a per-board key so that the
+    same peg mask on two boards hashes differently. A jump changes exactly
+    three holes, so a hash is kept up to date with three XORs per move,
+    the same in both directions.
+
+    Wide boards (wide_board.h) have up to 65536 cells, so their 128-bit
+    keys are derived from the cell index on the fly instead of being
+    stored in a table.
+*/
+
+#ifndef ZOBRIST_H
+#define ZOBRIST_H
+
+#include <stdint.h>
+#include "geometry.h"
+
+typedef uint64_t ZobristKey;
+
+// Well-mixed 64-bit value of x (SplitMix64 finalizer)
+constexpr uint64_t splitMix64(uint64_t x) {
+    x += 0x9E3779B97F4A7C15ULL;
+    x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    x = (x ^ (x >> 27)) * 0x94D049BB133111EBULL;
+    return x ^ (x >> 31);
+}
+
+struct ZobristTable {
+    ZobristKey hole[MAX_HOLES];
+    ZobristKey board[NUM_GEOMETRIES];
+};
+
+constexpr ZobristTable buildZobristTable() {
+    ZobristTable t = {};
+    for (int h = 0; h < MAX_HOLES; h++)
+        t.hole[h] = splitMix64(0x5EED0000ULL + h);
+    for (int g = 0; g < NUM_GEOMETRIES; g++)
+        t.board[g] = splitMix64(0xB0A4D000ULL + g);
+    return t;
+}
+
+inline constexpr ZobristTable ZOBRIST = buildZobristTable();
+
+// Full hash of a position, for setting up a new position
+inline ZobristKey zobristHash(const Geometry &geo, Bitboard pegs) {
+    ZobristKey key = ZOBRIST.board[geo.id];
+    while (pegs) {
+        key ^= ZOBRIST.hole[__builtin_ctzll(pegs)];
+        pegs &= pegs - 1;
+    }
+    return key;
+}
+
+// Hash change of a jump, applied or reverted
+inline ZobristKey zobristJump(const Jump &j) {
+    return ZOBRIST.hole[j.from] ^ ZOBRIST.hole[j.over] ^ ZOBRIST.hole[j.to];
+}
+
+/* ################################################################# */
+// 128-bit keys for wide boards //
+
+struct ZobristKey128 {
+    uint64_t lo, hi;
+
+    bool operator==(const ZobristKey128 &o) const { return lo == o.lo && hi == o.hi; }
+    bool operator!=(const ZobristKey128 &o) const { return !(*this == o); }
+    ZobristKey128 &operator^=(const ZobristKey128 &o) {
+        lo ^= o.lo;
+        hi ^= o.hi;
+        return *this;
+    }
+};
+
+// Key of the cell at row, col on a board up to 256 cells wide
+inline ZobristKey128 zobristCell128(int row, int col) {
+    uint64_t cell = (uint64_t)row << 8 | (uint64_t)col;
+    ZobristKey128 key = { splitMix64(cell * 2), splitMix64(cell * 2 + 1) };
+    return key;
+}
+
+#endif /* ZOBRIST_H */
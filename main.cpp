@@ -6,6 +6,8 @@
 #include <string>
 #include <vector>
 #include <ctime>
+#include <thread>
+#include <memory>
 #include <GL/glew.h>
 #include <GLFW/glfw3.h>
 
@@ -14,6 +16,11 @@
 #include "backends/imgui_impl_opengl3.h"
 #include "file_utils.h"
 #include "math_utils.h"
+#include "game_state.h"
+#include "solver.h"
+#include "solver_worker.h"
+#include "solvability_db.h"
+#include "position_index.h"
 
 #include <cmath>
 #ifndef M_PI
@@ -26,7 +33,6 @@ using namespace std;
 
 /* ################################################################# */
 // Variables //
-const int BOARD_SIZE = 7;
 char theProgramTitle[] = "Marble Solitaire";
 int theWindowWidth = 1000, theWindowHeight = 1000;
 int theWindowPositionX = 40, theWindowPositionY = 40;
@@ -36,7 +42,7 @@ float rotation = 0.0f;
 GLuint boardVBO, boardVAO, marbleVBO, marbleVAO;
 GLuint gWorldLocation, gColorLocation, gSelectedLocation;
 GLuint gPulseLocation;
-const int MAX_UNDO_MOVES = 3;  // Maximum number of undo/redo moves
+int undoDepth = 3;  // Maximum number of undo/redo moves (0 = unlimited), set with --undo-depth
 bool showUndoLimitMsg = false; // Flags for undo/redo limit notifications
 bool showRedoLimitMsg = false;
 float msgDisplayTime = 0.0f;
@@ -47,17 +53,54 @@ const float MSG_DISPLAY_DURATION = 2.0f; // Time for notification display in sec
 
 /* ################################################################# */
 // Game state //
-enum CellState { EMPTY = 0, FILLED = 1, INVALID = 2 };
-CellState boardState[BOARD_SIZE][BOARD_SIZE];
-bool isMarbleSelected = false;
-int selectedRow = -1, selectedCol = -1;
-int hoverRow = -1, hoverCol = -1;
-vector<pair<pair<int, int>, pair<int, int>>> moveHistory; // (from, to)
-vector<pair<pair<int, int>, pair<int, int>>> redoStack;
-int remainingMarbles = 0;
-time_t gameStartTime;
-bool gameWon = false;
-bool gameLost = false;
+GameSession session; // Board, rules, undo history and selection of the game being played
+const Geometry *geometry = NULL; // Geometry of the session's board, for layout and drawing
+/* ################################################################# */
+
+
+/* ################################################################# */
+// Background searches //
+// Runs every search below on its own thread, hint tables cached in BOARD.cache. Made in main() once
+// the game is set up and destroyed there before GLFW shuts down, so its thread never outlives the game.
+std::unique_ptr<SolverWorker> solverWorker;
+ZobristKey jobsHash = 0; // Position the posted jobs and the values below belong to
+const char *SOLVER_JOB_NAMES[NUM_SOLVER_JOBS] = { "hint", "moves left", "best possible", "MCTS" };
+/* ################################################################# */
+
+
+/* ################################################################# */
+// Hints //
+enum HintState { HINT_NONE = 0, HINT_SEARCHING = 1, HINT_READY = 2, HINT_NO_WIN = 3, HINT_BEST = 4 };
+SolvabilityDb solvabilityDb; // BOARD.sdb of the current board if it was built (see tools/build_db.cpp)
+PositionIndex positionIndex; // BOARD.idx of the current board if it was built (see tools/build_index.cpp)
+HintState hintState = HINT_NONE;
+Move hintMove; // Next jump of a winning line once hintState is HINT_READY, of a best line for HINT_BEST
+/* ################################################################# */
+
+
+/* ################################################################# */
+// Fewest moves left //
+bool showMovesLeft = false; // Toggled with M
+int movesLeft = -1; // Fewest moves to a single peg, -1 while searching, -2 if there is none
+int movesAtLeast = 0; // Lower bound proved so far while searching
+/* ################################################################# */
+
+
+/* ################################################################# */
+// Best possible outcome //
+int fewestPegs = -1; // Fewest pegs the position can be reduced to, -1 while searching
+int fewestFound = 0; // Fewest pegs of a line found so far while searching
+std::vector<Move> fewestLine; // A line reaching fewestPegs once it is known
+/* ################################################################# */
+
+
+/* ################################################################# */
+// Monte Carlo tree search: automatic play and MCTS hints //
+double mctsSecondsPerMove = 0.5; // Search time per decision, set with --mcts-ms
+int mctsThreads = 1; // Threads growing the tree, all cores unless set with --mcts-threads
+bool mctsHints = false; // Hints from MCTS instead of the exact solver, set with --hint mcts
+bool autoPlay = false; // Toggled with A
+int mctsBestPegs = 0; // Pegs left by the line of the last MCTS decision
 /* ################################################################# */
 
 
@@ -77,278 +120,288 @@ GLuint marbleShaderProgram;
 /* ################################################################# */
 
 /* ################################################################# */
-/* Utility functions */
+// Board layout in normalized device coordinates, derived from the geometry
+float cellSize = 2.0f / 7;
+float layoutMinX = 0.0f, layoutMinY = 0.0f;
+float layoutOffsetX = 0.0f, layoutOffsetY = 0.0f;
+/* ################################################################# */
 
+/* ################################################################# */
+/* Utility functions */
 
-// Initialize the board state
-void initializeBoard() {
-    // Reset counters
-    remainingMarbles = 0;
-    moveHistory.clear();
-    redoStack.clear();
-    gameWon = false;
-    gameLost = false;
-    gameStartTime = time(NULL);
-    
-    printf("Initializing board of size %d x %d\n", BOARD_SIZE, BOARD_SIZE);
-    
-    // Set up board with invalid regions (corners) and valid cells
-    for (int i = 0; i < BOARD_SIZE; i++) {
-        for (int j = 0; j < BOARD_SIZE; j++) {
-            if ((i < 2 || i >= BOARD_SIZE - 2) && (j < 2 || j >= BOARD_SIZE - 2)) {
-                boardState[i][j] = INVALID; // Invalid corners
-            } else {
-                boardState[i][j] = FILLED; // All other spaces have marbles
-                remainingMarbles++;
-            }
-        }
+// Fit the geometry's hole layout into the window, one cell per lattice unit
+void computeBoardLayout() {
+    float minX = geometry->holeX[0], maxX = minX;
+    float minY = geometry->holeY[0], maxY = minY;
+    for (int h = 1; h < geometry->numHoles; h++) {
+        minX = fmin(minX, geometry->holeX[h]);
+        maxX = fmax(maxX, geometry->holeX[h]);
+        minY = fmin(minY, geometry->holeY[h]);
+        maxY = fmax(maxY, geometry->holeY[h]);
     }
-    
-    // Create the central empty space
-    boardState[BOARD_SIZE/2][BOARD_SIZE/2] = EMPTY;
-    remainingMarbles--;
-    
-    printf("Board initialized with %d marbles\n", remainingMarbles);
+    float spanX = maxX - minX + 1.0f;
+    float spanY = maxY - minY + 1.0f;
+    cellSize = 2.0f / fmax(spanX, spanY);
+    layoutMinX = minX;
+    layoutMinY = minY;
+    // Center the shorter axis
+    layoutOffsetX = (2.0f - spanX * cellSize) / 2.0f;
+    layoutOffsetY = (2.0f - spanY * cellSize) / 2.0f;
 }
 
-// Check if the game is over (no more valid moves)
-bool checkGameOver() {
-    // Go through every position on the board
-    for (int i = 0; i < BOARD_SIZE; i++) {
-        for (int j = 0; j < BOARD_SIZE; j++) {
-            if (boardState[i][j] == FILLED) {
-                // Check all four directions for a valid move
-                // Check up
-                if (i >= 2 && boardState[i-1][j] == FILLED && boardState[i-2][j] == EMPTY)
-                    return false;
-                // Check down
-                if (i < BOARD_SIZE-2 && boardState[i+1][j] == FILLED && boardState[i+2][j] == EMPTY)
-                    return false;
-                // Check left
-                if (j >= 2 && boardState[i][j-1] == FILLED && boardState[i][j-2] == EMPTY)
-                    return false;
-                // Check right
-                if (j < BOARD_SIZE-2 && boardState[i][j+1] == FILLED && boardState[i][j+2] == EMPTY)
-                    return false;
-            }
-        }
-    }
-    
-    // If we got here, no valid moves were found
-    if (remainingMarbles == 1) {
-        gameWon = true;
-    } else {
-        gameLost = true;
-    }
-    return true;
+// Queue a search of the current position on the worker
+void postSolverJob(SolverJobKind kind) {
+    const GameState &game = session.state();
+    SolverJob job = { kind, game.geometryId(), game.board().pegs, mctsSecondsPerMove, mctsThreads };
+    solverWorker->post(job);
 }
 
-// Check if a move is valid
-bool isValidMove(int startRow, int startCol, int endRow, int endCol) {
-    // Check if start and end positions are valid
-    if (startRow < 0 || startRow >= BOARD_SIZE || startCol < 0 || startCol >= BOARD_SIZE ||
-        endRow < 0 || endRow >= BOARD_SIZE || endCol < 0 || endCol >= BOARD_SIZE)
-        return false;
-        
-    // Start must have a marble, end must be empty
-    if (boardState[startRow][startCol] != FILLED || boardState[endRow][endCol] != EMPTY)
-        return false;
-        
-    // Move must be exactly two spaces horizontally or vertically
-    if ((abs(startRow - endRow) == 2 && startCol == endCol) || 
-        (abs(startCol - endCol) == 2 && startRow == endRow)) {
-        
-        // Check the marble to be jumped over
-        int middleRow = (startRow + endRow) / 2;
-        int middleCol = (startCol + endCol) / 2;
-        
-        return boardState[middleRow][middleCol] == FILLED;
-    }
-    
-    return false;
+// Start searching the fewest moves left, unless the game already decided it
+void startMovesLeft() {
+    const GameState &game = session.state();
+    movesLeft = -1;
+    movesAtLeast = 0;
+    if (game.isOver())
+        movesLeft = game.status() == GAME_WON ? 0 : -2;
+    else
+        postSolverJob(JOB_MOVES_LEFT);
 }
 
-// Make a move on the board with undo limit
-void makeMove(int startRow, int startCol, int endRow, int endCol) {
-    if (!isValidMove(startRow, startCol, endRow, endCol))
+// Cancel the searches of the previous position and start the ones the
+// current position needs. Called right after every move, undo and redo,
+// and once per frame to catch any other change of the board.
+void boardChanged() {
+    const GameState &game = session.state();
+    if (game.hash() == jobsHash)
         return;
-        
-    int middleRow = (startRow + endRow) / 2;
-    int middleCol = (startCol + endCol) / 2;
-    
-    // Update board state
-    boardState[startRow][startCol] = EMPTY;
-    boardState[middleRow][middleCol] = EMPTY;
-    boardState[endRow][endCol] = FILLED;
-    
-    // Record move in history
-    moveHistory.push_back(std::make_pair(std::make_pair(startRow, startCol), 
-                                         std::make_pair(endRow, endCol)));
-    
-    // Limit the undo stack to MAX_UNDO_MOVES by removing the oldest move if necessary
-    if (moveHistory.size() > MAX_UNDO_MOVES) {
-        moveHistory.erase(moveHistory.begin()); // Remove the oldest move
+    jobsHash = game.hash();
+    solverWorker->cancel();
+
+    hintState = HINT_NONE;
+    fewestPegs = -1;
+    fewestFound = game.remainingPegs();
+    fewestLine.clear();
+    mctsBestPegs = game.remainingPegs();
+    postSolverJob(JOB_FEWEST_PEGS);
+    if (showMovesLeft)
+        startMovesLeft();
+    if (autoPlay && !game.isOver())
+        postSolverJob(JOB_MCTS);
+}
+
+// Start a new game on the given board and fit it into the window
+void initializeBoard(GeometryId id) {
+    // Also clears the selection and restarts the clock
+    session.newGame(id);
+    geometry = &session.state().geometry();
+    computeBoardLayout();
+    printf("Initializing %s board with %d holes\n", geometry->name, geometry->numHoles);
+    printf("Board initialized with %d marbles\n", session.state().remainingPegs());
+
+    // Hints become lookups when the board has a solvability database
+    if (!solvabilityDb.isOpen() || solvabilityDb.board() != id) {
+        std::string path = std::string(geometry->name) + ".sdb";
+        if (solvabilityDb.open(path.c_str()))
+            printf("Loaded solvability database %s\n", path.c_str());
     }
-    
-    // Clear redo stack when a new move is made (branching history)
-    redoStack.clear();
-    
-    // Reset notification flags when a new move is made
-    showUndoLimitMsg = false;
-    showRedoLimitMsg = false;
-    
-    // Update marble count
-    remainingMarbles--;
-    
-    // Check if game is over
-    checkGameOver();
+    if (!positionIndex.isOpen() || positionIndex.board() != id) {
+        std::string path = std::string(geometry->name) + ".idx";
+        if (positionIndex.open(path.c_str()))
+            printf("Loaded position index %s\n", path.c_str());
+    }
+    // A new board can hash like the old one, so its searches always restart
+    jobsHash = 0;
+    boardChanged();
 }
 
-// Undo the last move, limited by MAX_UNDO_MOVES
+// Undo the last move, limited by the undo depth
 void undoMove() {
-    if (moveHistory.empty()) {
+    // Step back in the history; the move stays in the buffer for redo
+    if (!session.state().undo()) {
         showUndoLimitMsg = true;
+        showRedoLimitMsg = false;
         msgDisplayTime = glfwGetTime();
-        return;
-    }
-    
-    // Get the last move
-    auto lastMove = moveHistory.back();
-    moveHistory.pop_back();
-    
-    // Add to redo stack
-    redoStack.push_back(lastMove);
-    
-    // Limit the redo stack to MAX_UNDO_MOVES by removing the oldest move if necessary
-    if (redoStack.size() > MAX_UNDO_MOVES) {
-        redoStack.erase(redoStack.begin()); // Remove the oldest move
     }
-    
-    // Restore positions
-    int startRow = lastMove.first.first;
-    int startCol = lastMove.first.second;
-    int endRow = lastMove.second.first;
-    int endCol = lastMove.second.second;
-    int middleRow = (startRow + endRow) / 2;
-    int middleCol = (startCol + endCol) / 2;
-    
-    // Restore board state
-    boardState[startRow][startCol] = FILLED;
-    boardState[middleRow][middleCol] = FILLED;
-    boardState[endRow][endCol] = EMPTY;
-    
-    // Update marble count
-    remainingMarbles++;
-    
-    // Reset game over flags
-    gameWon = false;
-    gameLost = false;
+    boardChanged();
 }
 
-// Redo the last undone move
+// Redo the last undone move, if there is one
 void redoMove() {
-    if (redoStack.empty()) {
-        return;
+    if (!session.state().redo()) {
+        showRedoLimitMsg = true;
+        showUndoLimitMsg = false;
+        msgDisplayTime = glfwGetTime();
     }
-    
-    // Get the last undone move
-    auto redoMove = redoStack.back();
-    redoStack.pop_back();
-    
-    // Add back to history
-    moveHistory.push_back(redoMove);
-    
-    // Limit the undo stack to MAX_UNDO_MOVES by removing the oldest move if necessary
-    if (moveHistory.size() > MAX_UNDO_MOVES) {
-        moveHistory.erase(moveHistory.begin()); // Remove the oldest move
+    boardChanged();
+}
+
+// Ask for a hint on the current position; without a solvability database
+// it is searched in the background
+void requestHint() {
+    const GameState &game = session.state();
+    if (game.isOver()) {
+        hintState = game.status() == GAME_WON ? HINT_NONE : HINT_NO_WIN;
+    } else if (solvabilityDb.isOpen() && !mctsHints) {
+        Move winning[MAX_JUMPS];
+        if (solvabilityDb.winningMoves(game.board().pegs, winning) > 0) {
+            hintMove = winning[0];
+            hintState = HINT_READY;
+        } else {
+            hintState = HINT_NO_WIN;
+        }
+    } else {
+        // MCTS cannot prove a position lost, so its hint is the first move
+        // of the best line found in the time per move
+        hintState = HINT_SEARCHING;
+        postSolverJob(mctsHints ? JOB_MCTS : JOB_HINT);
     }
-    
-    // Apply the move
-    int startRow = redoMove.first.first;
-    int startCol = redoMove.first.second;
-    int endRow = redoMove.second.first;
-    int endCol = redoMove.second.second;
-    int middleRow = (startRow + endRow) / 2;
-    int middleCol = (startCol + endCol) / 2;
-    
-    // Update board state
-    boardState[startRow][startCol] = EMPTY;
-    boardState[middleRow][middleCol] = EMPTY;
-    boardState[endRow][endCol] = FILLED;
-    
-    // Update marble count
-    remainingMarbles--;
-    
-    // Check if game is over
-    checkGameOver();
 }
 
-// Get the pixel coordinates for a board position
-void getBoardPixelCoordinates(int row, int col, float &x, float &y) {
-    float cellSize = 2.0f / BOARD_SIZE;
-    x = -1.0f + col * cellSize + cellSize / 2.0f;
-    y = 1.0f - row * cellSize - cellSize / 2.0f;
-    
-    // printf("X :%f, Y:%f\n",x,y);
+// Apply the results the worker finished since the last frame; results of
+// positions left since are dropped by the worker
+void pollSolverWorker() {
+    SolverJobResult r;
+    while (solverWorker->poll(r)) {
+        switch (r.kind) {
+        case JOB_HINT:
+            if (hintState != HINT_SEARCHING)
+                break;
+            if (r.result == SOLVE_WIN && !r.line.empty()) {
+                hintMove = r.line[0];
+                hintState = HINT_READY;
+            } else {
+                hintState = HINT_NO_WIN;
+            }
+            break;
+        case JOB_MOVES_LEFT:
+            if (!r.final)
+                movesAtLeast = std::max(movesAtLeast, r.value);
+            else
+                movesLeft = r.result == SOLVE_WIN ? r.value : -2;
+            break;
+        case JOB_FEWEST_PEGS:
+            fewestFound = std::min(fewestFound, r.value);
+            if (r.final) {
+                fewestPegs = r.value;
+                fewestLine = r.line;
+            }
+            break;
+        case JOB_MCTS:
+            if (r.result != SOLVE_WIN || r.line.empty())
+                break;
+            mctsBestPegs = r.value;
+            if (mctsHints && hintState == HINT_SEARCHING) {
+                hintMove = r.line[0];
+                hintState = HINT_READY;
+            }
+            // Playing the move cancels the rest of this frame's results
+            if (autoPlay && !session.state().isOver()) {
+                session.clearSelection();
+                session.state().makeMove(r.line[0]);
+                boardChanged();
+            }
+            break;
+        default:
+            break;
+        }
+    }
+
+    // A lost position still gets the first jump of its best line
+    if (hintState == HINT_NO_WIN && fewestPegs > 1 && !fewestLine.empty()) {
+        hintMove = fewestLine[0];
+        hintState = HINT_BEST;
+    }
 }
 
-// Convert mouse coordinates to board coordinates
-void getBoardCoordinates(double mouseX, double mouseY, int &row, int &col) {
+// Get the pixel coordinates for the center of a hole
+void getHolePixelCoordinates(int hole, float &x, float &y) {
+    x = -1.0f + layoutOffsetX + (geometry->holeX[hole] - layoutMinX) * cellSize + cellSize / 2.0f;
+    y = 1.0f - layoutOffsetY - (geometry->holeY[hole] - layoutMinY) * cellSize - cellSize / 2.0f;
+}
+
+// Convert mouse coordinates to the hole under the cursor, -1 if none
+int getBoardHole(double mouseX, double mouseY) {
     // Convert mouse coordinates to normalized device coordinates
     float x = (2.0f * mouseX / theWindowWidth) - 1.0f;
     float y = 1.0f - (2.0f * mouseY / theWindowHeight);
     
-    // Calculate the board position
-    float cellSize = 2.0f / BOARD_SIZE;
-    col = (int)((x + 1.0f) / cellSize);
-    row = (int)((1.0f - y) / cellSize);
-    
-    // Clamp to valid board coordinates
-    if (row < 0) row = 0;
-    if (row >= BOARD_SIZE) row = BOARD_SIZE - 1;
-    if (col < 0) col = 0;
-    if (col >= BOARD_SIZE) col = BOARD_SIZE - 1;
+    // Pick the nearest hole center, as long as the cursor is inside its cell
+    int best = -1;
+    float bestDist = cellSize * cellSize / 4.0f;
+    for (int h = 0; h < geometry->numHoles; h++) {
+        float centerX, centerY;
+        getHolePixelCoordinates(h, centerX, centerY);
+        float dist = (x - centerX) * (x - centerX) + (y - centerY) * (y - centerY);
+        if (dist < bestDist) {
+            bestDist = dist;
+            best = h;
+        }
+    }
+    return best;
+}
+
+// Number of vertices in one board tile: a square, or a hexagon on hex lattices
+int tileVertexCount() {
+    return geometry->lattice == LATTICE_HEX ? 18 : 6;
 }
 
 // Create the board vertex buffer
 void CreateBoardVertexBuffer() {
-    // Create squares for each cell on the board
+    // Create a tile for each hole on the board
     std::vector<float> vertices;
-    float cellSize = 2.0f / BOARD_SIZE;
     
-    for (int i = 0; i < BOARD_SIZE; i++) {
-        for (int j = 0; j < BOARD_SIZE; j++) {
-            if (boardState[i][j] != INVALID) {
-                float x = -1.0f + j * cellSize;
-                float y = 1.0f - i * cellSize;
-                
-                // Add square (made of two triangles)
-                // First triangle
-                vertices.push_back(x);
-                vertices.push_back(y);
-                vertices.push_back(0.0f);
-                
-                vertices.push_back(x + cellSize);
-                vertices.push_back(y);
-                vertices.push_back(0.0f);
-                
-                vertices.push_back(x);
-                vertices.push_back(y - cellSize);
-                vertices.push_back(0.0f);
-                
-                // Second triangle
-                vertices.push_back(x + cellSize);
-                vertices.push_back(y);
+    for (int h = 0; h < geometry->numHoles; h++) {
+        float centerX, centerY;
+        getHolePixelCoordinates(h, centerX, centerY);
+        
+        if (geometry->lattice == LATTICE_HEX) {
+            // Pointy-top hexagon made of six triangles around the center
+            float radius = cellSize / sqrtf(3.0f);
+            for (int k = 0; k < 6; k++) {
+                float a0 = (float)M_PI / 6.0f + k * (float)M_PI / 3.0f;
+                float a1 = a0 + (float)M_PI / 3.0f;
+                vertices.push_back(centerX);
+                vertices.push_back(centerY);
                 vertices.push_back(0.0f);
                 
-                vertices.push_back(x + cellSize);
-                vertices.push_back(y - cellSize);
+                vertices.push_back(centerX + radius * cos(a0));
+                vertices.push_back(centerY + radius * sin(a0));
                 vertices.push_back(0.0f);
                 
-                vertices.push_back(x);
-                vertices.push_back(y - cellSize);
+                vertices.push_back(centerX + radius * cos(a1));
+                vertices.push_back(centerY + radius * sin(a1));
                 vertices.push_back(0.0f);
             }
+        } else {
+            float x = centerX - cellSize / 2.0f;
+            float y = centerY + cellSize / 2.0f;
+            
+            // Add square (made of two triangles)
+            // First triangle
+            vertices.push_back(x);
+            vertices.push_back(y);
+            vertices.push_back(0.0f);
+            
+            vertices.push_back(x + cellSize);
+            vertices.push_back(y);
+            vertices.push_back(0.0f);
+            
+            vertices.push_back(x);
+            vertices.push_back(y - cellSize);
+            vertices.push_back(0.0f);
+            
+            // Second triangle
+            vertices.push_back(x + cellSize);
+            vertices.push_back(y);
+            vertices.push_back(0.0f);
+            
+            vertices.push_back(x + cellSize);
+            vertices.push_back(y - cellSize);
+            vertices.push_back(0.0f);
+            
+            vertices.push_back(x);
+            vertices.push_back(y - cellSize);
+            vertices.push_back(0.0f);
         }
     }
     
@@ -374,43 +427,34 @@ void CreateBoardVertexBuffer() {
 void CreateMarbleVertexBuffer() {
     std::vector<float> vertices;
     const int segments = 32;
-    const float radius = 0.8f / BOARD_SIZE;  // Slightly smaller than cell
+    const float radius = 0.4f * cellSize;  // Slightly smaller than cell
     const float zOffset = -0.1f;  // Add a small Z offset to ensure marbles appear in front
     
-    printf("Creating marbles for board of size %d x %d\n", BOARD_SIZE, BOARD_SIZE);
-    int validCells = 0;
+    printf("Creating marbles for %s board\n", geometry->name);
     int marbleCount = 0;
     
-    // Create vertices for marbles
-    for (int i = 0; i < BOARD_SIZE; i++) {
-        for (int j = 0; j < BOARD_SIZE; j++) {
-            if (boardState[i][j] != INVALID) {
-                validCells++;
-                float centerX, centerY;
-                getBoardPixelCoordinates(i, j, centerX, centerY);
-                
-                if (boardState[i][j] == FILLED) {
-                    marbleCount++;
-                }
-                
-                // Center vertex (use 0,0,0 as the relative center for each marble)
-                vertices.push_back(0.0f);  // Relative x (will be transformed in shader)
-                vertices.push_back(0.0f);  // Relative y (will be transformed in shader)
-                vertices.push_back(zOffset);  // Z offset
-                
-                // Circle vertices
-                for (int k = 0; k <= segments; k++) {
-                    float angle = 2.0f * M_PI * k / segments;
-                    // Store positions relative to center, scaled by radius
-                    vertices.push_back(radius * cos(angle));  // Relative x
-                    vertices.push_back(radius * sin(angle));  // Relative y
-                    vertices.push_back(zOffset);  // Z offset
-                }
-            }
+    // Create vertices for marbles, one circle per hole
+    for (int h = 0; h < geometry->numHoles; h++) {
+        if (session.state().holeState(h) == FILLED) {
+            marbleCount++;
+        }
+        
+        // Center vertex (use 0,0,0 as the relative center for each marble)
+        vertices.push_back(0.0f);  // Relative x (will be transformed in shader)
+        vertices.push_back(0.0f);  // Relative y (will be transformed in shader)
+        vertices.push_back(zOffset);  // Z offset
+        
+        // Circle vertices
+        for (int k = 0; k <= segments; k++) {
+            float angle = 2.0f * M_PI * k / segments;
+            // Store positions relative to center, scaled by radius
+            vertices.push_back(radius * cos(angle));  // Relative x
+            vertices.push_back(radius * sin(angle));  // Relative y
+            vertices.push_back(zOffset);  // Z offset
         }
     }
     
-    printf("Board has %d valid cells and %d marbles\n", validCells, marbleCount);
+    printf("Board has %d valid cells and %d marbles\n", geometry->numHoles, marbleCount);
     printf("Created %lu vertices for marbles\n", vertices.size() / 3);
     
     // Generate buffers and vertex array
@@ -431,6 +475,19 @@ void CreateMarbleVertexBuffer() {
     glBindVertexArray(0);
 }
 
+// Switch to another board layout and start a new game on it
+void selectGeometry(GeometryId id) {
+    initializeBoard(id);
+    
+    // Rebuild the board and marble buffers for the new layout
+    glDeleteVertexArrays(1, &boardVAO);
+    glDeleteBuffers(1, &boardVBO);
+    glDeleteVertexArrays(1, &marbleVAO);
+    glDeleteBuffers(1, &marbleVBO);
+    CreateBoardVertexBuffer();
+    CreateMarbleVertexBuffer();
+}
+
 void AddShader(GLuint ShaderProgram, const char *pShaderText, GLenum ShaderType) {
     GLuint ShaderObj = glCreateShader(ShaderType);
     
@@ -565,7 +622,7 @@ static void CompileShaders() {
 
 void onInit(int argc, char *argv[]) {
     // Initialize board
-    initializeBoard();
+    initializeBoard(session.state().geometryId());
     
     // Create vertex buffers
     CreateBoardVertexBuffer();
@@ -586,6 +643,14 @@ void onInit(int argc, char *argv[]) {
 
 // Modify onDisplay to clear depth buffer properly and use blending
 static void onDisplay() {
+    boardChanged();
+    pollSolverWorker();
+    int hintFrom = -1, hintTo = -1;
+    if (hintState == HINT_READY || hintState == HINT_BEST) {
+        hintFrom = moveJump(*geometry, hintMove).from;
+        hintTo = moveJump(*geometry, hintMove).to;
+    }
+    
     // Set background color to a dark, modern color from the suggested palette
     glClearColor(0.11f, 0.15f, 0.20f, 1.0f);  // #1B2631 (Almost black modern theme)
     glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
@@ -601,23 +666,25 @@ static void onDisplay() {
     
     glBindVertexArray(boardVAO);
     
-    // Draw each cell
-    int cellCount = 0;
-    for (int i = 0; i < BOARD_SIZE; i++) {
-        for (int j = 0; j < BOARD_SIZE; j++) {
-            if (boardState[i][j] != INVALID) {
-                // Use a dark wood theme for the checkerboard pattern
-                if ((i + j) % 2 == 0) {
-                    glUniform3f(gColorLocation, 0.24f, 0.15f, 0.14f); // #3E2723 Dark brown
-                } else {
-                    glUniform3f(gColorLocation, 0.36f, 0.25f, 0.22f); // #5D4037 Warm brown
-                }
-                
-                // Draw the cell (2 triangles)
-                glDrawArrays(GL_TRIANGLES, cellCount * 6, 6);
-                cellCount++;
-            }
+    // Draw each hole's tile
+    int tileVertices = tileVertexCount();
+    for (int h = 0; h < geometry->numHoles; h++) {
+        int i = geometry->holeRow[h];
+        int j = geometry->holeCol[h];
+        // Use a dark wood theme for the checkerboard pattern (three colors on hex lattices)
+        int shade = geometry->lattice == LATTICE_HEX ? (i + j) % 3 : (i + j) % 2;
+        if (h == hintTo) {
+            glUniform3f(gColorLocation, 0.55f, 0.45f, 0.10f); // Landing hole of the hinted jump
+        } else if (shade == 0) {
+            glUniform3f(gColorLocation, 0.24f, 0.15f, 0.14f); // #3E2723 Dark brown
+        } else if (shade == 1) {
+            glUniform3f(gColorLocation, 0.36f, 0.25f, 0.22f); // #5D4037 Warm brown
+        } else {
+            glUniform3f(gColorLocation, 0.30f, 0.20f, 0.18f); // #4E342E Medium brown
         }
+        
+        // Draw the tile
+        glDrawArrays(GL_TRIANGLES, h * tileVertices, tileVertices);
     }
     
     // Now draw the marbles
@@ -630,41 +697,38 @@ static void onDisplay() {
     glBindVertexArray(marbleVAO);
     
     // Draw each marble
-    int marbleOffset = 0;
+    Bitboard movable = session.state().movablePegs();
     int marblesDrawn = 0;
     
-    for (int i = 0; i < BOARD_SIZE; i++) {
-        for (int j = 0; j < BOARD_SIZE; j++) {
-            if (boardState[i][j] != INVALID) {
-                // Skip drawing if cell is empty
-                if (boardState[i][j] == FILLED) {
-                    // Calculate center position for this marble
-                    float centerX, centerY;
-                    getBoardPixelCoordinates(i, j, centerX, centerY);
-                    
-                    // Create model matrix for this marble
-                    Matrix4f marbleModel;
-                    marbleModel.InitTranslationTransform(centerX, centerY, 0.0f);
-                    
-                    // Apply the world transformation
-                    Matrix4f marbleTransform = world * marbleModel;
-                    glUniformMatrix4fv(gWorldLocation, 1, GL_TRUE, &marbleTransform.m[0][0]);
-                    
-                    // Highlight selected marble
-                    if (isMarbleSelected && i == selectedRow && j == selectedCol) {
-                        glUniform1i(gSelectedLocation, 1);
-                    } else if (hoverRow == i && hoverCol == j) {
-                        glUniform1i(gSelectedLocation, 2); // Hover state
-                    } else {
-                        glUniform1i(gSelectedLocation, 0);
-                    }
-                    
-                    // Draw the marble as a triangle fan (center + segments)
-                    glDrawArrays(GL_TRIANGLE_FAN, marbleOffset, 33);
-                    marblesDrawn++;
-                }
-                marbleOffset += 33; // Move to next marble position
+    for (int h = 0; h < geometry->numHoles; h++) {
+        // Skip drawing if hole is empty
+        if (session.state().holeState(h) == FILLED) {
+            // Calculate center position for this marble
+            float centerX, centerY;
+            getHolePixelCoordinates(h, centerX, centerY);
+            
+            // Create model matrix for this marble
+            Matrix4f marbleModel;
+            marbleModel.InitTranslationTransform(centerX, centerY, 0.0f);
+            
+            // Apply the world transformation
+            Matrix4f marbleTransform = world * marbleModel;
+            glUniformMatrix4fv(gWorldLocation, 1, GL_TRUE, &marbleTransform.m[0][0]);
+            
+            // Highlight selected marble
+            if (h == session.selectedHole()) {
+                glUniform1i(gSelectedLocation, 1);
+            } else if (h == hintFrom) {
+                glUniform1i(gSelectedLocation, 3); // Marble to move next on a winning line
+            } else if (session.hoverHole() == h && bbTest(movable, h)) {
+                glUniform1i(gSelectedLocation, 2); // Hover state, only for marbles that can jump
+            } else {
+                glUniform1i(gSelectedLocation, 0);
             }
+            
+            // Draw the marble as a triangle fan (center + segments), one per hole
+            glDrawArrays(GL_TRIANGLE_FAN, h * 34, 34);
+            marblesDrawn++;
         }
     }
     
@@ -680,39 +744,31 @@ static void onDisplay() {
 }
 
 void mouse_callback(GLFWwindow* window, double xpos, double ypos) {
+    // These callbacks replace the ones ImGui installed, so pass events on
+    ImGui_ImplGlfw_CursorPosCallback(window, xpos, ypos);
+    
     // Update the hover position
-    getBoardCoordinates(xpos, ypos, hoverRow, hoverCol);
+    session.setHoverHole(getBoardHole(xpos, ypos));
 }
 
 void mouse_button_callback(GLFWwindow* window, int button, int action, int mods) {
+    ImGui_ImplGlfw_MouseButtonCallback(window, button, action, mods);
+    
+    // Clicks on ImGui windows (the Hint button) are not board clicks
+    if (ImGui::GetIO().WantCaptureMouse)
+        return;
+    
     if (button == GLFW_MOUSE_BUTTON_LEFT) {
         if (action == GLFW_PRESS) {
             double xpos, ypos;
             glfwGetCursorPos(window, &xpos, &ypos);
             
-            int row, col;
-            getBoardCoordinates(xpos, ypos, row, col);
-            
-            // Check if clicked on a valid board position
-            if (row >= 0 && row < BOARD_SIZE && col >= 0 && col < BOARD_SIZE) {
-                if (!isMarbleSelected) {
-                    // Select a marble
-                    if (boardState[row][col] == FILLED) {
-                        isMarbleSelected = true;
-                        selectedRow = row;
-                        selectedCol = col;
-                    }
-                } else {
-                    // Try to move the selected marble
-                    if (isValidMove(selectedRow, selectedCol, row, col)) {
-                        makeMove(selectedRow, selectedCol, row, col);
-                    }
-                    
-                    // Deselect the marble
-                    isMarbleSelected = false;
-                    selectedRow = -1;
-                    selectedCol = -1;
-                }
+            // Select a marble, or jump the selected one to the clicked hole
+            if (session.clickHole(getBoardHole(xpos, ypos))) {
+                // Reset notification flags when a new move is made
+                showUndoLimitMsg = false;
+                showRedoLimitMsg = false;
+                boardChanged();
             }
         }
     }
@@ -722,12 +778,8 @@ void key_callback(GLFWwindow* window, int key, int scancode, int action, int mod
     if (action == GLFW_PRESS) {
         switch (key) {
         case GLFW_KEY_R:
-            // Reset the game
-            initializeBoard();
-            // Clear selection
-            isMarbleSelected = false;
-            selectedRow = -1;
-            selectedCol = -1;
+            // Reset the game (also clears the selection)
+            initializeBoard(session.state().geometryId());
             // Reset notification flags
             showUndoLimitMsg = false;
             showRedoLimitMsg = false;
@@ -746,11 +798,36 @@ void key_callback(GLFWwindow* window, int key, int scancode, int action, int mod
                 redoMove();
             }
             break;
+        case GLFW_KEY_H:
+            // Show the next jump of a winning line
+            requestHint();
+            break;
+        case GLFW_KEY_M:
+            // Show or hide the fewest moves left
+            showMovesLeft = !showMovesLeft;
+            if (showMovesLeft)
+                startMovesLeft();
+            break;
+        case GLFW_KEY_A:
+            // Let MCTS play the game out, or take back control
+            autoPlay = !autoPlay;
+            if (autoPlay && !session.state().isOver())
+                postSolverJob(JOB_MCTS);
+            break;
         case GLFW_KEY_ESCAPE:
             // Cancel selection
-            isMarbleSelected = false;
-            selectedRow = -1;
-            selectedCol = -1;
+            session.clearSelection();
+            break;
+        case GLFW_KEY_1:
+        case GLFW_KEY_2:
+        case GLFW_KEY_3:
+        case GLFW_KEY_4:
+        case GLFW_KEY_5:
+            // Switch board layout
+            selectGeometry((GeometryId)(key - GLFW_KEY_1));
+            // Reset notification flags
+            showUndoLimitMsg = false;
+            showRedoLimitMsg = false;
             break;
         case GLFW_KEY_Q:
             glfwSetWindowShouldClose(window, true);
@@ -787,14 +864,16 @@ void RenderImGui() {
     ImGui_ImplGlfw_NewFrame();
     ImGui::NewFrame();
     
+    const GameState &game = session.state();
+    const MoveHistory &history = game.history();
+    
     // Set a larger font scale for the time and marble displays
     float originalFontScale = ImGui::GetFont()->Scale;
     float largeFontScale = 2.0f;
     
     // Display game stats directly on the game board in top corners
     // Create time display in top-left corner with improved styling
-    time_t currentTime = time(NULL);
-    int playTime = difftime(currentTime, gameStartTime);
+    int playTime = session.elapsedSeconds();
     int minutes = playTime / 60;
     int seconds = playTime % 60;
     
@@ -826,7 +905,8 @@ void RenderImGui() {
     // Marble count display
     ImGui::PushStyleColor(ImGuiCol_Text, ImVec4(0.75f, 1.0f, 0.0f, 1.0f));      // Lime Green (#BFFF00)
     ImGui::PushStyleColor(ImGuiCol_WindowBg, ImVec4(0.2f, 0.2f, 0.2f, 0.7f));   // Semi-transparent Dark Gray
-    ImGui::Text(" Marbles: %d ", remainingMarbles);
+    ImGui::Text(" Marbles: %d ", game.remainingPegs());
+    ImGui::Text(" Moves: %d ", game.countMoves());
     ImGui::PopStyleColor(2);
     ImGui::End();
     
@@ -834,7 +914,7 @@ void RenderImGui() {
     ImGui::GetFont()->Scale = originalFontScale; // Restore original font scale
     
     // Game status (win/lose) displayed in center when applicable
-    if (gameWon || gameLost ) {
+    if (game.isOver()) {
         ImGui::SetNextWindowPos(ImVec2(theWindowWidth / 2 - 170, theWindowHeight / 2 - 50));
         ImGui::SetNextWindowSize(ImVec2(340, 100));
         ImGui::SetNextWindowBgAlpha(0.7f);
@@ -843,7 +923,7 @@ void RenderImGui() {
             ImGuiWindowFlags_NoMove | ImGuiWindowFlags_NoScrollbar | 
             ImGuiWindowFlags_NoSavedSettings | ImGuiWindowFlags_AlwaysAutoResize);
         
-        if (gameWon ) {
+        if (game.status() == GAME_WON) {
             ImGui::TextColored(ImVec4(0.0f, 1.0f, 0.0f, 1.0f), "    Congratulations! \n\n        You won!");
         } else {
             ImGui::TextColored(ImVec4(1.0f, 0.0f, 0.0f, 1.0f), "       Game over.\n\n Better luck next time!");
@@ -863,15 +943,19 @@ void RenderImGui() {
     ImGui::PushStyleColor(ImGuiCol_Text, ImVec4(0.9f, 0.9f, 0.9f, 1.0f));
     
     // Show text about undo/redo stack status
-    ImGui::Text(" History Status\n   Undo: %d/%d  ",
-        (int)moveHistory.size(), MAX_UNDO_MOVES
+    if (history.isUnlimited()) {
+        ImGui::Text(" History Status\n   Undo: %d  ", history.undoCount());
+    } else {
+        ImGui::Text(" History Status\n   Undo: %d/%d  ",
+            history.undoCount(), history.depth()
 );
+    }
     
     ImGui::PopStyleColor();
     ImGui::End();
     
     // Show notification messages for undo/redo limits
-    currentTime = glfwGetTime();
+    double currentTime = glfwGetTime();
     
     if (showUndoLimitMsg && (currentTime - msgDisplayTime < MSG_DISPLAY_DURATION)) {
         ImGui::SetNextWindowPos(ImVec2(theWindowWidth / 2 - 170, 120));
@@ -897,15 +981,16 @@ void RenderImGui() {
             ImGuiWindowFlags_NoMove | ImGuiWindowFlags_NoScrollbar | 
             ImGuiWindowFlags_NoSavedSettings | ImGuiWindowFlags_AlwaysAutoResize);
         
-        ImGui::TextColored(ImVec4(1.0f, 0.5f, 0.0f, 1.0f), "Maximum redo limit of %d moves reached!", MAX_UNDO_MOVES);
+        ImGui::TextColored(ImVec4(1.0f, 0.5f, 0.0f, 1.0f), "Nothing to redo!");
         ImGui::End();
     } else {
         showRedoLimitMsg = false;
     }
     
     // Keep keyboard controls in a separate window in bottom left
-    ImGui::SetNextWindowPos(ImVec2(30, theWindowHeight - 230));
-    ImGui::SetNextWindowSize(ImVec2(215, 160));
+    ImGui::SetNextWindowPos(ImVec2(30, theWindowHeight - 290));
+    ImGui::SetNextWindowSize(ImVec2(215, 280 + (solvabilityDb.isOpen() ? 20 : 0) + (positionIndex.isOpen() ? 20 : 0) +
+                                             (showMovesLeft ? 20 : 0) + (autoPlay ? 20 : 0)));
     ImGui::Begin("Controls", NULL, ImGuiWindowFlags_NoResize | ImGuiWindowFlags_NoCollapse);
     
     // Use smaller font for controls section
@@ -917,16 +1002,84 @@ void RenderImGui() {
     ImGui::Text("Keyboard Controls:");
     ImGui::Separator();
     ImGui::BulletText("R: Reset game");
-    ImGui::BulletText("Ctrl+Z: Undo move (max %d)", MAX_UNDO_MOVES);
+    if (history.isUnlimited()) {
+        ImGui::BulletText("Ctrl+Z: Undo move");
+    } else {
+        ImGui::BulletText("Ctrl+Z: Undo move (max %d)", history.depth());
+    }
     ImGui::BulletText("Ctrl+Y: Redo move");
     ImGui::BulletText("ESC: Cancel selection");
+    ImGui::BulletText("1-5: Board (%s)", geometry->name);
+    ImGui::BulletText("H: Hint");
+    ImGui::BulletText("M: Fewest moves left");
+    ImGui::BulletText("A: Automatic play");
     ImGui::BulletText("Q: Quit game");
     
+    // Hint button and the state of the hint search
+    if (ImGui::Button("Hint")) {
+        requestHint();
+    }
+    ImGui::SameLine();
+    if (hintState == HINT_SEARCHING) {
+        ImGui::Text("Searching...");
+    } else if (hintState == HINT_READY) {
+        ImGui::TextColored(ImVec4(1.0f, 0.84f, 0.0f, 1.0f), "Move the yellow marble");
+    } else if (hintState == HINT_NO_WIN) {
+        ImGui::TextColored(ImVec4(1.0f, 0.5f, 0.0f, 1.0f), "No winning line");
+    } else if (hintState == HINT_BEST) {
+        ImGui::TextColored(ImVec4(1.0f, 0.84f, 0.0f, 1.0f), "Yellow marble: best line, %d pegs", fewestPegs);
+    }
+    if (fewestPegs >= 0)
+        ImGui::Text("Best possible: %d peg%s", fewestPegs, fewestPegs == 1 ? "" : "s");
+    else
+        ImGui::Text("Best possible: %d or fewer...", fewestFound);
+    if (solvabilityDb.isOpen()) {
+        bool winnable = solvabilityDb.winnable(session.state().board().pegs);
+        ImGui::Text("Position: %s", winnable ? "winnable" : "lost");
+    }
+    PositionInfo info;
+    if (positionIndex.isOpen() && positionIndex.lookup(session.state().board().pegs, info)) {
+        if (info.solutions == UINT64_MAX)
+            ImGui::Text("Solutions: too many to count");
+        else
+            ImGui::Text("Solutions: %llu", (unsigned long long)info.solutions);
+    }
+    if (showMovesLeft) {
+        if (movesLeft >= 0)
+            ImGui::Text("Moves left: %d", movesLeft);
+        else if (movesLeft == -2)
+            ImGui::Text("Moves left: no win");
+        else
+            ImGui::Text("Moves left: at least %d...", movesAtLeast);
+    }
+    if (autoPlay) {
+        ImGui::Text("Auto: best line %d pegs", mctsBestPegs);
+    }
+    
     ImGui::PopFont();
     // Restore original font scale before ending the window
     ImGui::GetFont()->Scale = originalFontScale;
     ImGui::End();
     
+    // Background searches above the instructions: what runs and how fast
+    SolverProgress progress = solverWorker->progress();
+    ImGui::SetNextWindowPos(ImVec2(theWindowWidth - 280, theWindowHeight - 320));
+    ImGui::SetNextWindowSize(ImVec2(270, 100));
+    ImGui::Begin("Solver", NULL, ImGuiWindowFlags_NoResize | ImGuiWindowFlags_NoCollapse);
+    if (progress.jobs == 0) {
+        ImGui::Text("Idle");
+    } else {
+        std::string running;
+        for (int k = 0; k < NUM_SOLVER_JOBS; k++) {
+            if (progress.jobs >> k & 1)
+                running += std::string(running.empty() ? "" : ", ") + SOLVER_JOB_NAMES[k];
+        }
+        ImGui::Text("Searching: %s", running.c_str());
+        ImGui::Text("Nodes: %llu", (unsigned long long)progress.nodes);
+        ImGui::Text("Speed: %.0fk nodes/s", progress.nodesPerSecond / 1000);
+    }
+    ImGui::End();
+    
     // Put game instructions in bottom right corner
     ImGui::SetNextWindowPos(ImVec2(theWindowWidth - 280, theWindowHeight - 210));
     ImGui::SetNextWindowSize(ImVec2(270, 100));
@@ -949,6 +1102,32 @@ void RenderImGui() {
 
 // Define main function
 int main(int argc, char *argv[]) {
+    // Parse command line options
+    GeometryId geometryId = GEOMETRY_ENGLISH;
+    mctsThreads = std::max(1, (int)std::thread::hardware_concurrency());
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--undo-depth") == 0 && i + 1 < argc) {
+            undoDepth = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--board") == 0 && i + 1 < argc) {
+            if (!findGeometry(argv[++i], geometryId)) {
+                fprintf(stderr, "Unknown board '%s', using english\n", argv[i]);
+                geometryId = GEOMETRY_ENGLISH;
+            }
+        } else if (strcmp(argv[i], "--hint") == 0 && i + 1 < argc) {
+            mctsHints = strcmp(argv[++i], "mcts") == 0;
+        } else if (strcmp(argv[i], "--mcts-ms") == 0 && i + 1 < argc) {
+            double ms = atof(argv[++i]);
+            if (ms > 0)
+                mctsSecondsPerMove = ms / 1000;
+            else
+                fprintf(stderr, "--mcts-ms needs a positive time, using %.0f\n", mctsSecondsPerMove * 1000);
+        } else if (strcmp(argv[i], "--mcts-threads") == 0 && i + 1 < argc) {
+            mctsThreads = std::max(1, atoi(argv[++i]));
+        }
+    }
+    session.state().setUndoDepth(undoDepth);
+    session.newGame(geometryId);
+    
     // Initialize GLFW
     glfwInit();
     
@@ -974,6 +1153,7 @@ int main(int argc, char *argv[]) {
     glewExperimental = GL_TRUE;
     glewInit();
     printf("GL version: %s\n", glGetString(GL_VERSION));
+    solverWorker.reset(new SolverWorker("."));
     onInit(argc, argv);
     
     // Initialize ImGui
@@ -989,6 +1169,7 @@ int main(int argc, char *argv[]) {
     if (!vs_file) {
         fprintf(stderr, "Error: Could not open vertex shader file '%s'\n", pVSFileName);
         fprintf(stderr, "Make sure the shaders directory exists and contains the shader files.\n");
+        solverWorker.reset();
         glfwTerminate();
         return 1;
     }
@@ -998,6 +1179,7 @@ int main(int argc, char *argv[]) {
     if (!fs_file) {
         fprintf(stderr, "Error: Could not open fragment shader file '%s'\n", pFSFileName);
         fprintf(stderr, "Make sure the shaders directory exists and contains the shader files.\n");
+        solverWorker.reset();
         glfwTerminate();
         return 1;
     }
@@ -1007,6 +1189,7 @@ int main(int argc, char *argv[]) {
     if (!mvs_file) {
         fprintf(stderr, "Error: Could not open marble vertex shader file '%s'\n", pMarbleVSFileName);
         fprintf(stderr, "Make sure the shaders directory exists and contains the shader files.\n");
+        solverWorker.reset();
         glfwTerminate();
         return 1;
     }
@@ -1016,6 +1199,7 @@ int main(int argc, char *argv[]) {
     if (!mfs_file) {
         fprintf(stderr, "Error: Could not open marble fragment shader file '%s'\n", pMarbleFSFileName);
         fprintf(stderr, "Make sure the shaders directory exists and contains the shader files.\n");
+        solverWorker.reset();
         glfwTerminate();
         return 1;
     }
@@ -1038,7 +1222,8 @@ int main(int argc, char *argv[]) {
     ImGui_ImplGlfw_Shutdown();
     ImGui::DestroyContext();
     
-    // Terminate GLFW
+    // Stop the background searches, then terminate GLFW
+    solverWorker.reset();
     glfwTerminate();
     return 0;
 }
@@ -0,0 +1,221 @@
+#include <math.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include "beam_search.h"
+#include "geometry.h"
+#include "thread_utils.h"
+
+/* ################################################################# */
+// Evaluation functions //
+
+// Bits of a padded row shifted by one column: bit c of the result is bit
+// c + 1 (next) or c - 1 (previous) of the row
+static inline uint64_t nextColumn(const uint64_t *row, int k) {
+    return (row[k] >> 1) | (k + 1 < WIDE_ROW_WORDS ? row[k + 1] << 63 : 0);
+}
+
+static inline uint64_t prevColumn(const uint64_t *row, int k) {
+    return (row[k] << 1) | (k > 0 ? row[k - 1] >> 63 : 0);
+}
+
+double wideIsolatedScore(const WideBoard &board, void *) {
+    const uint64_t *pegs = board.pegWords();
+    int isolated = 0;
+    for (int r = 0; r < board.height(); r++) {
+        const uint64_t *row = pegs + (r + WIDE_GUARD_ROWS) * WIDE_ROW_WORDS;
+        for (int k = 0; k < WIDE_ROW_WORDS; k++) {
+            uint64_t neighbours = nextColumn(row, k) | prevColumn(row, k) | row[k - WIDE_ROW_WORDS] |
+                                  row[k + WIDE_ROW_WORDS];
+            isolated += __builtin_popcountll(row[k] & ~neighbours);
+        }
+    }
+    return -isolated;
+}
+
+// Weights 1/phi^d, d the distance from the central cell: a jump towards
+// the centre keeps the total and any other jump lowers it
+struct GoldenWeights {
+    double weight[2 * WIDE_MAX_SIZE];
+
+    GoldenWeights() {
+        for (int d = 0; d < 2 * WIDE_MAX_SIZE; d++)
+            weight[d] = pow(0.6180339887498949, d);
+    }
+};
+
+double widePagodaScore(const WideBoard &board, void *) {
+    static const GoldenWeights golden;  // Built on first use, thread-safe since C++11
+    const double *weight = golden.weight;
+    int centerRow = board.height() / 2, centerCol = board.width() / 2;
+    const uint64_t *pegs = board.pegWords();
+    double total = 0;
+    for (int r = 0; r < board.height(); r++) {
+        const uint64_t *row = pegs + (r + WIDE_GUARD_ROWS) * WIDE_ROW_WORDS;
+        int dr = abs(r - centerRow);
+        for (int k = 0; k < WIDE_ROW_WORDS; k++) {
+            for (uint64_t bits = row[k]; bits; bits &= bits - 1)
+                total += weight[dr + abs(k * 64 + __builtin_ctzll(bits) - centerCol)];
+        }
+    }
+    return total;
+}
+
+// Corner holes lack a hole on one side in both directions
+double wideCornerScore(const WideBoard &board, void *) {
+    const uint64_t *holes = board.holeWords();
+    const uint64_t *pegs = board.pegWords();
+    int corners = 0;
+    for (int r = 0; r < board.height(); r++) {
+        int base = (r + WIDE_GUARD_ROWS) * WIDE_ROW_WORDS;
+        const uint64_t *row = holes + base;
+        for (int k = 0; k < WIDE_ROW_WORDS; k++) {
+            uint64_t jumpable = (nextColumn(row, k) & prevColumn(row, k)) |
+                                (row[k - WIDE_ROW_WORDS] & row[k + WIDE_ROW_WORDS]);
+            corners += __builtin_popcountll(pegs[base + k] & row[k] & ~jumpable);
+        }
+    }
+    return -corners;
+}
+
+BeamOptions defaultBeamOptions() {
+    BeamOptions options;
+    options.width = 1000;
+    options.threads = 1;
+    options.seconds = 0;
+    options.memoryBytes = 0;
+    options.evaluate = widePagodaScore;
+    options.evaluateUser = NULL;
+    options.progress = NULL;
+    options.progressUser = NULL;
+    return options;
+}
+
+/* ################################################################# */
+// Search //
+
+// A child of the current layer, before it is known whether it is kept
+struct BeamCandidate {
+    ZobristKey128 hash;
+    double score;
+    uint32_t parent;  // Index in the current layer
+    WideMove move;
+};
+
+// How a kept position was reached, for rebuilding the line
+struct BeamStep {
+    uint32_t parent;
+    WideMove move;
+};
+
+// Better first; equal scores fall back on the key so that runs repeat
+static bool betterCandidate(const BeamCandidate &a, const BeamCandidate &b) {
+    if (a.score != b.score)
+        return a.score > b.score;
+    if (a.hash.hi != b.hash.hi)
+        return a.hash.hi < b.hash.hi;
+    return a.hash.lo < b.hash.lo;
+}
+
+static bool smallerKey(const BeamCandidate &a, const BeamCandidate &b) {
+    return a.hash.hi != b.hash.hi ? a.hash.hi < b.hash.hi : a.hash.lo < b.hash.lo;
+}
+
+BeamResult wideBeamSearch(const WideBoard &start, const BeamOptions &options) {
+    std::chrono::steady_clock::time_point begin = std::chrono::steady_clock::now();
+    int threads = options.threads < 1 ? 1 : options.threads;
+    WideEvaluation evaluate = options.evaluate ? options.evaluate : widePagodaScore;
+
+    // Two layers of boards take half the memory budget at most; the move
+    // history and the candidates live in the other half
+    size_t boardBytes = sizeof(WideBoard) + 2 * start.paddedWords() * sizeof(uint64_t);
+    size_t width = options.width < 1 ? 1 : options.width;
+    if (options.memoryBytes)
+        width = std::max((size_t)1, std::min(width, options.memoryBytes / 4 / boardBytes));
+
+    BeamResult result;
+    result.bestPegs = start.pegCount();
+    result.layers = 0;
+    result.positions = 0;
+    result.exhausted = false;
+
+    std::vector<WideBoard> layer(1, start);
+    std::vector<std::vector<BeamStep> > history;
+    size_t historyBytes = 0;
+    while (true) {
+        // Expand and score every position of the layer
+        std::vector<std::vector<BeamCandidate> > found(threads);
+        std::atomic<size_t> next(0);
+        runThreads(threads, [&](int t) {
+            std::vector<WideMove> moves;
+            size_t i;
+            while ((i = next.fetch_add(1)) < layer.size()) {
+                WideBoard board = layer[i];
+                board.generateMoves(moves);
+                for (size_t m = 0; m < moves.size(); m++) {
+                    board.applyMove(moves[m]);
+                    BeamCandidate c = { board.hash(), evaluate(board, options.evaluateUser), (uint32_t)i,
+                                        moves[m] };
+                    found[t].push_back(c);
+                    board.revertMove(moves[m]);
+                }
+            }
+        });
+        std::vector<BeamCandidate> candidates;
+        for (int t = 0; t < threads; t++)
+            candidates.insert(candidates.end(), found[t].begin(), found[t].end());
+        result.positions += candidates.size();
+        if (candidates.empty()) {
+            result.exhausted = true;
+            break;
+        }
+
+        // Merge transpositions, then keep the best
+        std::sort(candidates.begin(), candidates.end(), smallerKey);
+        candidates.erase(std::unique(candidates.begin(), candidates.end(),
+                                     [](const BeamCandidate &a, const BeamCandidate &b) { return a.hash == b.hash; }),
+                         candidates.end());
+        if (candidates.size() > width) {
+            std::nth_element(candidates.begin(), candidates.begin() + width, candidates.end(), betterCandidate);
+            candidates.resize(width);
+        }
+        std::sort(candidates.begin(), candidates.end(), betterCandidate);
+
+        std::vector<WideBoard> children(candidates.size());
+        std::vector<BeamStep> steps(candidates.size());
+        next = 0;
+        runThreads(threads, [&](int) {
+            size_t i;
+            while ((i = next.fetch_add(1)) < candidates.size()) {
+                children[i] = layer[candidates[i].parent];
+                children[i].applyMove(candidates[i].move);
+                steps[i].parent = candidates[i].parent;
+                steps[i].move = candidates[i].move;
+            }
+        });
+        layer.swap(children);
+        history.push_back(steps);
+        historyBytes += steps.size() * sizeof(BeamStep);
+        result.layers++;
+        result.bestPegs = layer[0].pegCount();
+        if (options.progress)
+            options.progress(result.layers, result.bestPegs, layer.size(), candidates[0].score,
+                             options.progressUser);
+
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+        if ((options.seconds > 0 && seconds >= options.seconds) ||
+            (options.memoryBytes && historyBytes + layer.size() * boardBytes * 2 > options.memoryBytes))
+            break;
+    }
+
+    // Walk the history back from the best position of the deepest layer,
+    // the first one since every layer is sorted
+    size_t best = 0;
+    result.line.resize(history.size());
+    for (size_t l = history.size(); l-- > 0;) {
+        result.line[l] = history[l][best].move;
+        best = history[l][best].parent;
+    }
+    result.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+    return result;
+}
@@ -0,0 +1,221 @@
+#include <algorithm>
+#include <chrono>
+#include "bidirectional.h"
+#include "pruning.h"
+#include "static_engine.h"
+
+// Forward nodes of the first round, before the backward side has done
+// any work to match
+static const uint64_t FIRST_ROUND_NODES = 1 << 16;
+
+template <GeometryId G>
+struct BidirectionalSearch {
+    typedef StaticEngine<G> Engine;
+    typedef std::vector<Bitboard> Layer;
+
+    DeadTable &dead;
+    BidirectionalStats &stats;
+    std::vector<Move> &line;         // Filled in reverse on the way back up
+    uint32_t symmetries;             // Symmetries keeping the goal
+    PagodaCuts forward;              // Cuts toward the goal
+    PagodaCuts backward;             // The same pagodas, least at the start's complement
+    Layer frontier;                  // Positions of frontierPegs pegs that reach the goal
+    int frontierPegs;
+    uint64_t nodeLimit;              // Forward nodes of the current round, 0 = no limit
+    uint64_t roundNodes;
+    bool aborted;
+    Bitboard meeting;                // Frontier position the forward line ends on
+
+    BidirectionalSearch(DeadTable &dead, BidirectionalStats &stats, std::vector<Move> &line)
+        : dead(dead), stats(stats), line(line), symmetries(0), frontierPegs(1), nodeLimit(0), roundNodes(0),
+          aborted(false), meeting(0) {}
+
+    Bitboard canonical(Bitboard pegs) const { return Engine::canonical(pegs, symmetries); }
+
+    bool reachableFromStart(Bitboard pegs) const { return !backward.below(Engine::HOLES & ~pegs); }
+
+    // Sort and merge the positions after middle into the sorted ones before
+    static void merge(Layer &next, size_t middle) {
+        std::sort(next.begin() + middle, next.end());
+        next.erase(std::unique(next.begin() + middle, next.end()), next.end());
+        std::inplace_merge(next.begin(), next.begin() + middle, next.end());
+        next.erase(std::unique(next.begin(), next.end()), next.end());
+    }
+
+    // The frontier's parents (jumps on the complement), canonical, sorted
+    // and without duplicates. Most positions are found several times, so
+    // the unsorted tail is merged in whenever it outgrows the sorted part.
+    // False, with next dropped, once the layer has more than maxPositions.
+    // Adds the parents generated, the work done, to generated.
+    bool expand(Layer &next, uint64_t maxPositions, uint64_t &generated) const {
+        static const size_t MIN_TAIL = 1 << 20;
+        size_t sorted = 0;
+        for (size_t i = 0; i < frontier.size(); i++) {
+            Move moves[MAX_JUMPS];
+            Bitboard pegs = frontier[i];
+            int n = Engine::generateMoves(Engine::HOLES & ~pegs, moves);
+            for (int m = 0; m < n; m++) {
+                Bitboard parent = pegs ^ Engine::moveMask(moves[m]);
+                if (reachableFromStart(parent))
+                    next.push_back(canonical(parent));
+            }
+            generated += n;
+            if (next.size() - sorted >= std::max(MIN_TAIL, sorted)) {
+                merge(next, sorted);
+                sorted = next.size();
+                if (sorted > maxPositions) {
+                    Layer().swap(next);
+                    return false;
+                }
+            }
+        }
+        merge(next, sorted);
+        if (next.size() > maxPositions) {
+            Layer().swap(next);
+            return false;
+        }
+        next.shrink_to_fit();
+        return true;
+    }
+
+    // Depth first down to the frontier's peg count, like Solver
+    bool search(Bitboard pegs, int pegCount) {
+        if (pegCount == frontierPegs) {
+            if (!std::binary_search(frontier.begin(), frontier.end(), canonical(pegs)))
+                return false;
+            meeting = pegs;
+            return true;
+        }
+        if (forward.below(pegs))
+            return false;
+        Bitboard canon = canonical(pegs);
+        ZobristKey key = splitMix64(canon);
+        if (dead.contains(key, canon))
+            return false;
+        if (nodeLimit && roundNodes >= nodeLimit) {
+            aborted = true;
+            return false;
+        }
+        roundNodes++;
+        stats.nodes++;
+
+        Move moves[MAX_JUMPS];
+        int n = Engine::generateMoves(pegs, moves);
+        for (int i = 0; i < n; i++) {
+            if (search(pegs ^ Engine::moveMask(moves[i]), pegCount - 1)) {
+                line.push_back(moves[i]);
+                return true;
+            }
+            if (aborted)
+                return false;
+        }
+        dead.insert(key, canon);
+        return false;
+    }
+
+    static SolveResult run(DeadTable &dead, Bitboard pegs, int targetHole, uint64_t maxPositions,
+                           uint64_t nodeLimit, BidirectionalStats &stats, BidirectionalProgress progress, void *user,
+                           std::vector<Move> &line) {
+        const Geometry &geo = Engine::geo;
+        pegs &= Engine::HOLES;
+        if (pegs == 0)
+            return SOLVE_DEAD;
+        BidirectionalSearch s(dead, stats, line);
+        s.symmetries = targetHole >= 0 ? symmetriesFixing(geo, targetHole) : allSymmetries(geo);
+
+        // The last peg stands on a hole of the start's class; the goal is
+        // widened again to its images so that it is closed under the
+        // symmetries in use
+        Bitboard goal = targetHole >= 0 ? bbBit(targetHole) : Engine::HOLES;
+        goal = symmetricGoal(geo, classGoal(geo, pegs, goal), s.symmetries);
+        if (goal == 0)
+            return SOLVE_DEAD;
+
+        // Backward, the complement of a position must weigh at least as much
+        // as the start's
+        s.forward = goalPagodas(geo, goal);
+        s.backward = s.forward;
+        for (size_t k = 0; k < s.backward.pagodas.size(); k++)
+            s.backward.least[k] = pagodaValue(s.backward.pagodas[k], Engine::HOLES & ~pegs);
+
+        for (Bitboard g = goal; g; g &= g - 1)
+            s.frontier.push_back(s.canonical(bbBit(bbLowest(g))));
+        std::sort(s.frontier.begin(), s.frontier.end());
+        s.frontier.erase(std::unique(s.frontier.begin(), s.frontier.end()), s.frontier.end());
+        stats.positions = s.frontier.size();
+
+        // Rounds until one side settles the position; once the frontier
+        // reaches its limit the forward search goes on without one
+        int startPegs = bbPopCount(pegs);
+        uint64_t backwardWork = 0;
+        bool grows = maxPositions > 0;
+        SolveResult result = SOLVE_UNKNOWN;
+        while (result == SOLVE_UNKNOWN) {
+            grows = grows && s.frontierPegs + 1 < startPegs;
+            s.nodeLimit = grows ? std::max(FIRST_ROUND_NODES, backwardWork) : 0;
+            if (nodeLimit && (s.nodeLimit == 0 || s.nodeLimit > nodeLimit - stats.nodes))
+                s.nodeLimit = nodeLimit - stats.nodes;
+            s.roundNodes = 0;
+            s.aborted = false;
+            line.clear();
+            if (s.search(pegs, startPegs))
+                result = SOLVE_WIN;
+            else if (!s.aborted)
+                result = SOLVE_DEAD;
+            if (result != SOLVE_UNKNOWN || (nodeLimit && stats.nodes >= nodeLimit))
+                break;
+            if (!grows)
+                continue;
+
+            Layer next;
+            grows = s.expand(next, maxPositions, backwardWork);
+            if (!grows)
+                continue;
+            s.frontier.swap(next);
+            s.frontierPegs++;
+            stats.positions += s.frontier.size();
+            if (progress)
+                progress("backward", s.frontierPegs, s.frontier.size(), user);
+            // No position of this many pegs can be won
+            if (s.frontier.empty())
+                result = SOLVE_DEAD;
+        }
+        stats.frontier = s.frontier.size();
+        stats.forwardDepth = startPegs - s.frontierPegs;
+        stats.backwardDepth = s.frontierPegs - 1;
+        if (result != SOLVE_WIN) {
+            line.clear();
+            return result;
+        }
+
+        // From the meeting position, a few pegs, the rest of the line is a
+        // short search of its own
+        std::reverse(line.begin(), line.end());
+        if (s.frontierPegs > 1) {
+            Solver finish(20);
+            std::vector<Move> rest;
+            if (finish.solve(G, s.meeting, rest, targetHole) != SOLVE_WIN)
+                return SOLVE_DEAD;
+            line.insert(line.end(), rest.begin(), rest.end());
+        }
+        return SOLVE_WIN;
+    }
+};
+
+SolveResult solveBidirectional(GeometryId id, Bitboard pegs, std::vector<Move> &line, int targetHole,
+                               uint64_t maxPositions, uint64_t nodeLimit, BidirectionalStats *stats,
+                               BidirectionalProgress progress, void *user) {
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    const Geometry &geo = getGeometry(id);
+    if (targetHole >= geo.numHoles)
+        targetHole = -1;
+    line.clear();
+    DeadTable dead(BIDIRECTIONAL_DEAD_SLOTS_LOG2);
+    BidirectionalStats local = BidirectionalStats();
+    SolveResult result = dispatchGeometry<BidirectionalSearch>(id, dead, pegs, targetHole, maxPositions, nodeLimit,
+                                                                local, progress, user, line);
+    local.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    if (stats)
+        *stats = local;
+    return result;
+}
@@ -0,0 +1,109 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include "catalog.h"
+#include "move_solver.h"
+#include "thread_utils.h"
+
+CatalogOptions defaultCatalogOptions() {
+    CatalogOptions options;
+    options.threads = 1;
+    options.nodeLimit = 0;
+    options.pruning = PRUNE_ALL;
+    options.minimizeMoves = false;
+    return options;
+}
+
+// Index of the smallest image of the pair (start, finish) under the board
+// symmetries, the pair searched for its whole orbit
+static int orbitRepresentative(const Geometry &geo, int start, int finish) {
+    int best = start * geo.numHoles + finish;
+    for (int s = 0; s < geo.numSymmetries; s++)
+        best = std::min(best, geo.symmetry[s][start] * geo.numHoles + geo.symmetry[s][finish]);
+    return best;
+}
+
+// Jobs and results shared by the threads of a catalog build
+struct CatalogBuild {
+    GeometryId id;
+    const CatalogOptions &options;
+    std::vector<CatalogEntry> &entries;
+    std::vector<int> jobs;         // Entries to search, grouped by finish hole
+    std::atomic<size_t> next;      // Next job to take
+    std::mutex progressLock;
+    int done;
+    CatalogProgress progress;
+    void *user;
+
+    CatalogBuild(GeometryId id, const CatalogOptions &options, std::vector<CatalogEntry> &entries)
+        : id(id), options(options), entries(entries), next(0), done(0), progress(NULL), user(NULL) {}
+
+    void work() {
+        const Geometry &geo = getGeometry(id);
+        // The move solver's tables are large, so it is only made when used
+        Solver solver;
+        solver.setPruning(options.pruning);
+        std::unique_ptr<MoveSolver> moveSolver(options.minimizeMoves ? new MoveSolver() : NULL);
+        std::vector<Move> line;
+
+        for (size_t j = next++; j < jobs.size(); j = next++) {
+            CatalogEntry &e = entries[jobs[j]];
+            Bitboard pegs = initialBoard(geo, e.start).pegs;
+            std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+            if (moveSolver) {
+                e.result = moveSolver->solve(id, pegs, line, e.finish, options.nodeLimit);
+                e.nodes = moveSolver->stats().nodes;
+            } else {
+                e.result = solver.solve(id, pegs, line, e.finish, options.nodeLimit);
+                e.nodes = solver.stats().nodes;
+            }
+            e.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+            e.moves = e.result == SOLVE_WIN ? countChainMoves(geo, line) : 0;
+
+            if (progress) {
+                std::lock_guard<std::mutex> guard(progressLock);
+                progress(e, ++done, (int)jobs.size(), user);
+            }
+        }
+    }
+};
+
+std::vector<CatalogEntry> buildCatalog(GeometryId id, const CatalogOptions &options,
+                                       CatalogProgress progress, void *user) {
+    const Geometry &geo = getGeometry(id);
+    int n = geo.numHoles;
+    std::vector<CatalogEntry> entries(n * n);
+    CatalogBuild build(id, options, entries);
+    build.progress = progress;
+    build.user = user;
+
+    // Finish-major order keeps the jobs of one finish hole together
+    for (int finish = 0; finish < n; finish++) {
+        for (int start = 0; start < n; start++) {
+            int i = start * n + finish;
+            CatalogEntry &e = entries[i];
+            e = CatalogEntry();
+            e.start = start;
+            e.finish = finish;
+            e.solvedAs = orbitRepresentative(geo, start, finish);
+            if (e.solvedAs == i)
+                build.jobs.push_back(i);
+        }
+    }
+
+    int threads = std::max(1, std::min(options.threads, (int)build.jobs.size()));
+    runThreads(threads, [&build](int) { build.work(); });
+
+    // The rest of each orbit takes the answer of its searched pair
+    for (int i = 0; i < n * n; i++) {
+        CatalogEntry &e = entries[i];
+        if (e.solvedAs != i) {
+            const CatalogEntry &searched = entries[e.solvedAs];
+            e.result = searched.result;
+            e.moves = searched.moves;
+        }
+    }
+    return entries;
+}
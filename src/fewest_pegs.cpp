@@ -0,0 +1,186 @@
+#include <algorithm>
+#include <chrono>
+#include "fewest_pegs.h"
+#include "pruning.h"
+#include "static_engine.h"
+
+// Larger than any peg count, as the bound of a search that wants any result
+static const int NO_BOUND = 255;
+
+/* ################################################################# */
+// Lower bounds //
+
+// What the lower bound of a position needs about its board
+struct PegBounds {
+    PositionClasses classes;
+    int classFloor[16];                 // Fewest pegs of any position of each class
+    std::vector<Pagoda> pagodas;
+    std::vector<std::vector<int> > singleLeast;  // Per pagoda and class, least value of a single peg
+
+    explicit PegBounds(const Geometry &geo) : classes(positionClasses(geo)), pagodas(boardPagodas(geo)) {
+        // Single pegs, pairs and triples cover every class that occurs;
+        // a class none of them reaches needs at least four pegs
+        std::fill(classFloor, classFloor + 16, 4);
+        for (int a = geo.numHoles - 1; a >= 0; a--) {
+            for (int b = geo.numHoles - 1; b >= a; b--) {
+                for (int c = geo.numHoles - 1; c >= b; c--) {
+                    Bitboard pegs = bbBit(a) | bbBit(b) | bbBit(c);
+                    int n = bbPopCount(pegs);
+                    int &floor = classFloor[positionClass(classes, pegs)];
+                    floor = std::min(floor, n);
+                }
+            }
+        }
+        singleLeast.assign(pagodas.size(), std::vector<int>(16, 1 << 30));
+        for (size_t k = 0; k < pagodas.size(); k++) {
+            for (int h = 0; h < geo.numHoles; h++) {
+                int &least = singleLeast[k][positionClass(classes, bbBit(h))];
+                least = std::min(least, pagodaValue(pagodas[k], bbBit(h)));
+            }
+        }
+    }
+
+    int lowerBound(Bitboard pegs) const {
+        int c = positionClass(classes, pegs);
+        int floor = classFloor[c];
+        for (size_t k = 0; k < pagodas.size() && floor == 1; k++) {
+            if (pagodaValue(pagodas[k], pegs) < singleLeast[k][c])
+                floor = 2;
+        }
+        return floor;
+    }
+};
+
+/* ################################################################# */
+// Search //
+
+template <GeometryId G>
+struct FewestPegsSearch {
+    typedef StaticEngine<G> Engine;
+
+    MoveBoundTable &table;
+    FewestPegsStats &stats;
+    const PegBounds &bounds;
+    uint64_t nodeLimit;
+    bool aborted;
+    // Principal variation: pv[ply] is the best line found below the
+    // position at that ply, cut short where a value came from the table
+    Move pv[MAX_HOLES + 1][MAX_HOLES];
+    int pvLength[MAX_HOLES + 1];
+
+    // Fewest pegs reachable from pegs if that is below alpha, otherwise a
+    // lower bound of at least alpha. The root of a call skips the table
+    // so that its line is searched out.
+    int search(Bitboard pegs, int alpha, int ply) {
+        pvLength[ply] = 0;
+        int floor = bounds.lowerBound(pegs);
+        if (floor >= alpha) {
+            stats.boundCuts++;
+            return floor;
+        }
+        Bitboard canon = Engine::canonical(pegs);
+        uint64_t key = splitMix64(canon);
+        if (ply > 0) {
+            int entry = table.lookup(key, canon);
+            if (entry & 1) {
+                stats.tableHits++;
+                return entry >> 1;
+            }
+            if ((entry >> 1) > floor) {
+                floor = entry >> 1;
+                if (floor >= alpha) {
+                    stats.tableHits++;
+                    return floor;
+                }
+            }
+        }
+        if (nodeLimit && stats.nodes >= nodeLimit) {
+            aborted = true;
+            return NO_BOUND;
+        }
+        stats.nodes++;
+
+        Move moves[MAX_JUMPS];
+        int n = Engine::generateMoves(pegs, moves);
+        if (n == 0) {
+            int pegCount = bbPopCount(pegs);
+            table.store(key, canon, pegCount << 1 | 1);
+            return pegCount;
+        }
+        // Children with a result below limit are exact, and a new best
+        // takes over the line
+        int best = NO_BOUND;
+        for (int i = 0; i < n && best > floor; i++) {
+            int limit = std::min(alpha, best);
+            int result = search(pegs ^ Engine::moveMask(moves[i]), limit, ply + 1);
+            if (aborted)
+                return ply == 0 ? best : NO_BOUND;
+            if (result >= best)
+                continue;
+            best = result;
+            if (result < limit) {
+                pv[ply][0] = moves[i];
+                std::copy(pv[ply + 1], pv[ply + 1] + pvLength[ply + 1], pv[ply] + 1);
+                pvLength[ply] = pvLength[ply + 1] + 1;
+            }
+        }
+        best = std::max(best, floor);
+        table.store(key, canon, best << 1 | (best < alpha));
+        return best;
+    }
+
+    static SolveResult run(MoveBoundTable &table, FewestPegsStats &stats, Bitboard pegs, uint64_t nodeLimit,
+                           int &best, std::vector<Move> &line) {
+        pegs &= Engine::HOLES;
+        PegBounds bounds(Engine::geo);
+        FewestPegsSearch s = { table, stats, bounds, nodeLimit, false, {}, {} };
+        stats.lowerBound = bounds.lowerBound(pegs);
+
+        int result = s.search(pegs, NO_BOUND, 0);
+        SolveResult status = SOLVE_WIN;
+        if (s.aborted) {
+            status = SOLVE_UNKNOWN;
+            result = std::min(result, bbPopCount(pegs));
+        }
+        // A line cut short by a table value goes on from where it stopped
+        // with another search, which finds the rest in the table
+        best = result;
+        line.clear();
+        Bitboard end = pegs;
+        while (true) {
+            line.insert(line.end(), s.pv[0], s.pv[0] + s.pvLength[0]);
+            for (int i = 0; i < s.pvLength[0]; i++)
+                end ^= Engine::moveMask(s.pv[0][i]);
+            if (bbPopCount(end) <= best || s.pvLength[0] == 0 || status != SOLVE_WIN)
+                break;
+            s.nodeLimit = 0;
+            s.search(end, NO_BOUND, 0);
+        }
+        return status;
+    }
+};
+
+/* ################################################################# */
+// Solver //
+
+FewestPegsSolver::FewestPegsSolver(int log2TableSlots) : m_table(log2TableSlots) {
+    m_tableBoard = GEOMETRY_ENGLISH;
+    m_stats = FewestPegsStats();
+}
+
+void FewestPegsSolver::clear() {
+    m_table.clear();
+}
+
+SolveResult FewestPegsSolver::solve(GeometryId id, Bitboard pegs, int &best, std::vector<Move> &line,
+                                    uint64_t nodeLimit) {
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    if (id != m_tableBoard) {
+        m_table.clear();
+        m_tableBoard = id;
+    }
+    m_stats = FewestPegsStats();
+    SolveResult result = dispatchGeometry<FewestPegsSearch>(id, m_table, m_stats, pegs, nodeLimit, best, line);
+    m_stats.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return result;
+}
@@ -0,0 +1,142 @@
+#include "game_state.h"
+
+/* ################################################################# */
+// Game state //
+
+GameState::GameState(GeometryId id, int undoDepth) : m_history(undoDepth) {
+    newGame(id);
+}
+
+void GameState::newGame() {
+    newGame(geometryId());
+}
+
+void GameState::newGame(GeometryId id, int emptyHole) {
+    m_geometry = &getGeometry(id);
+    m_engine = &getEngineOps(id);
+    if (emptyHole < 0 || emptyHole >= m_geometry->numHoles)
+        emptyHole = m_geometry->defaultEmpty;
+
+    // Every hole filled except the starting vacancy
+    m_board = initialBoard(*m_geometry, emptyHole);
+    m_hash = zobristHash(*m_geometry, m_board.pegs);
+    m_remainingPegs = bbPopCount(m_board.pegs);
+    initMoveSet(m_legalMoves, *m_geometry, m_board);
+    m_history.clear();
+    updateStatus();
+}
+
+void GameState::setPosition(Bitboard pegs) {
+    m_board.pegs = pegs & m_board.holes;
+    m_hash = zobristHash(*m_geometry, m_board.pegs);
+    m_remainingPegs = bbPopCount(m_board.pegs);
+    initMoveSet(m_legalMoves, *m_geometry, m_board);
+    m_history.clear();
+    updateStatus();
+}
+
+CellState GameState::holeState(int hole) const {
+    if (hole < 0 || hole >= m_geometry->numHoles)
+        return INVALID;
+    return bbTest(m_board.pegs, hole) ? FILLED : EMPTY;
+}
+
+bool GameState::isValidMove(int startHole, int endHole) const {
+    // Move must be exactly two holes apart in a straight line
+    Move m;
+    if (!findMove(*m_geometry, startHole, endHole, m))
+        return false;
+    return isValidMove(m);
+}
+
+bool GameState::isValidMove(Move m) const {
+    // Start and middle must have a marble, end must be an empty hole
+    return m.from < m_geometry->numHoles && m.dir < m_geometry->numDirections &&
+           moveSetContains(*m_geometry, m_legalMoves, m);
+}
+
+bool GameState::makeMove(int startHole, int endHole) {
+    Move m;
+    if (!findMove(*m_geometry, startHole, endHole, m))
+        return false;
+    return makeMove(m);
+}
+
+bool GameState::makeMove(Move m) {
+    if (!isValidMove(m))
+        return false;
+    play(m);
+    m_history.push(m);
+    return true;
+}
+
+bool GameState::undo() {
+    // Step back in the history; the move stays in the buffer for redo
+    Move m;
+    if (!m_history.undo(m))
+        return false;
+    revertMove(*m_geometry, m_board, m);
+    m_hash ^= zobristJump(moveJump(*m_geometry, m));
+    updateMoveSet(m_legalMoves, *m_geometry, m_board, m);
+    m_remainingPegs++;
+    updateStatus();
+    return true;
+}
+
+bool GameState::redo() {
+    Move m;
+    if (!m_history.redo(m))
+        return false;
+    play(m);
+    return true;
+}
+
+// Apply a legal move to the board and everything derived from it
+void GameState::play(Move m) {
+    applyMove(*m_geometry, m_board, m);
+    m_hash ^= zobristJump(moveJump(*m_geometry, m));
+    updateMoveSet(m_legalMoves, *m_geometry, m_board, m);
+    m_remainingPegs--;
+    updateStatus();
+}
+
+// The live move set is maintained by every move, so this is a single test
+void GameState::updateStatus() {
+    if (!moveSetEmpty(m_legalMoves))
+        m_status = GAME_PLAYING;
+    else
+        m_status = m_remainingPegs == 1 ? GAME_WON : GAME_LOST;
+}
+
+/* ################################################################# */
+// Interactive session //
+
+GameSession::GameSession(GeometryId id, int undoDepth) : m_state(id, undoDepth) {
+    newGame(id);
+}
+
+void GameSession::newGame() {
+    newGame(m_state.geometryId());
+}
+
+void GameSession::newGame(GeometryId id) {
+    m_state.newGame(id);
+    m_selectedHole = -1;
+    m_hoverHole = -1;
+    m_startTime = time(NULL);
+}
+
+bool GameSession::clickHole(int hole) {
+    if (hole < 0)
+        return false;
+    if (!hasSelection()) {
+        // Select a marble
+        if (m_state.holeState(hole) == FILLED)
+            m_selectedHole = hole;
+        return false;
+    }
+    // Try to move the selected marble, then deselect it either way
+    bool moved = m_state.makeMove(m_selectedHole, hole);
+    m_selectedHole = -1;
+    return moved;
+}
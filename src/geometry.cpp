@@ -0,0 +1,16 @@
+#include <string.h>
+#include "geometry_tables.h"
+
+const Geometry &getGeometry(GeometryId id) {
+    return GEOMETRY_TABLE[id];
+}
+
+bool findGeometry(const char *name, GeometryId &id) {
+    for (int i = 0; i < NUM_GEOMETRIES; i++) {
+        if (strcmp(name, GEOMETRY_SPECS[i].name) == 0) {
+            id = (GeometryId)i;
+            return true;
+        }
+    }
+    return false;
+}
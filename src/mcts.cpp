@@ -0,0 +1,387 @@
+#include <math.h>
+#include <stdlib.h>
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include "mcts.h"
+#include "static_engine.h"
+#include "thread_utils.h"
+#include "zobrist.h"
+
+// Rewards are summed as fixed-point integers so that threads can add them
+// with one atomic instruction
+static const double REWARD_ONE = 1 << 20;
+
+MctsOptions defaultMctsOptions() {
+    MctsOptions options;
+    options.threads = 1;
+    options.seconds = 1.0;
+    options.playouts = 0;
+    options.exploration = 0.3;
+    options.virtualLoss = 3;
+    options.heuristicPlayouts = true;
+    options.seed = 1;
+    return options;
+}
+
+/* ################################################################# */
+// Games //
+
+// Rules of a bitboard board, as seen by the tree
+struct BitboardMctsGame {
+    typedef Bitboard Position;
+    typedef Move MoveType;
+
+    const EngineOps *ops;
+    const Geometry *geo;
+    float centreDistance[MAX_HOLES];  // Layout distance of each hole to the centre of the board
+
+    void setBoard(GeometryId id) {
+        ops = &getEngineOps(id);
+        geo = &getGeometry(id);
+        float x = 0, y = 0;
+        for (int h = 0; h < geo->numHoles; h++) {
+            x += geo->holeX[h];
+            y += geo->holeY[h];
+        }
+        x /= geo->numHoles;
+        y /= geo->numHoles;
+        for (int h = 0; h < geo->numHoles; h++)
+            centreDistance[h] = fabsf(geo->holeX[h] - x) + fabsf(geo->holeY[h] - y);
+    }
+
+    int pegs(Bitboard pegs) const { return bbPopCount(pegs); }
+    bool same(Bitboard a, Bitboard b) const { return a == b; }
+
+    void moves(Bitboard pegs, std::vector<Move> &out) const {
+        Move buffer[MAX_JUMPS];
+        int n = ops->generateMoves(pegs, buffer);
+        out.assign(buffer, buffer + n);
+    }
+
+    void apply(Bitboard &pegs, Move m) const { pegs ^= moveJump(*geo, m).mask; }
+
+    // How much closer to the centre the jumping peg lands
+    float centreGain(Move m) const {
+        const Jump &j = moveJump(*geo, m);
+        return centreDistance[j.from] - centreDistance[j.to];
+    }
+};
+
+// Rules of a wide board, as seen by the tree
+struct WideMctsGame {
+    typedef WideBoard Position;
+    typedef WideMove MoveType;
+
+    int rows, cols;  // Board size; distances are doubled to keep the centre on whole numbers
+
+    void setBoard(const WideBoard &board) {
+        rows = board.height();
+        cols = board.width();
+    }
+
+    int pegs(const WideBoard &board) const { return board.pegCount(); }
+    bool same(const WideBoard &a, const WideBoard &b) const { return a.hash() == b.hash(); }
+    void moves(const WideBoard &board, std::vector<WideMove> &out) const { board.generateMoves(out); }
+    void apply(WideBoard &board, WideMove m) const { board.applyMove(m); }
+
+    float centreGain(WideMove m) const {
+        return (float)(distance(m.row, m.col) - distance(WideBoard::targetRow(m), WideBoard::targetCol(m)));
+    }
+
+    int distance(int row, int col) const { return abs(2 * row - (rows - 1)) + abs(2 * col - (cols - 1)); }
+};
+
+/* ################################################################# */
+// Tree //
+
+template <class Game>
+class MctsTree {
+public:
+    typedef typename Game::Position Position;
+    typedef typename Game::MoveType MoveType;
+
+    Game game;
+
+    explicit MctsTree(size_t maxNodes) : m_nodes(maxNodes < 2 ? 2 : maxNodes), m_used(1), m_bestPegs(0) {
+        m_stats = MctsStats();
+    }
+
+    // New root; keepLine keeps the rest of the best line when pos follows
+    // its first move
+    void setPosition(const Position &pos, bool keepLine) {
+        if (keepLine && !m_bestLine.empty()) {
+            Position next = m_root;
+            game.apply(next, m_bestLine[0]);
+            keepLine = game.same(next, pos);
+        }
+        if (keepLine && !m_bestLine.empty()) {
+            m_bestLine.erase(m_bestLine.begin());
+        } else {
+            m_bestLine.clear();
+            m_bestPegs.store(game.pegs(pos));
+        }
+        m_root = pos;
+        m_rootPegs = game.pegs(pos);
+        std::vector<MoveType> moves;
+        game.moves(pos, moves);
+        m_rootMoves = moves.size();
+
+        Node &root = m_nodes[0];
+        root.visits.store(0);
+        root.reward.store(0);
+        root.state.store(NODE_LEAF);
+        root.numChildren = 0;
+        m_used.store(1);
+        m_stats = MctsStats();
+        m_stats.nodes = 1;
+        m_stats.bestPegs = m_bestPegs.load();
+    }
+
+    void search(const MctsOptions &options);
+
+    bool bestMove(MoveType &m) const {
+        if (m_rootMoves == 0)
+            return false;
+        if (!m_bestLine.empty()) {
+            m = m_bestLine[0];
+            return true;
+        }
+        // No playout yet: any legal move
+        std::vector<MoveType> moves;
+        game.moves(m_root, moves);
+        m = moves[0];
+        return true;
+    }
+
+    const std::vector<MoveType> &bestLine() const { return m_bestLine; }
+    const MctsStats &stats() const { return m_stats; }
+
+private:
+    enum NodeState {
+        NODE_LEAF = 0,       // Children not added yet
+        NODE_EXPANDING = 1,  // A thread is adding the children
+        NODE_EXPANDED = 2,
+        NODE_FINAL = 3       // No moves, or no room left in the pool: playouts only
+    };
+
+    struct Node {
+        std::atomic<uint32_t> visits;  // Backed-up playouts plus virtual losses in flight
+        std::atomic<uint64_t> reward;  // Sum of rewards, REWARD_ONE per full reward
+        std::atomic<uint8_t> state;
+        uint32_t firstChild;           // Children are contiguous in the pool; set before
+        uint32_t numChildren;          // state turns NODE_EXPANDED
+        MoveType move;                 // Move from the parent
+    };
+
+    // Scratch space of one thread
+    struct Worker {
+        uint64_t random;
+        Position pos;
+        std::vector<uint32_t> path;
+        std::vector<MoveType> line;
+        std::vector<MoveType> moves;
+
+        size_t next(size_t n) {
+            random += 0x9E3779B97F4A7C15ull;
+            return (size_t)(((unsigned __int128)splitMix64(random) * n) >> 64);
+        }
+    };
+
+    // Child with the best UCT score, with virtual losses counted as
+    // visits that brought nothing; unvisited children come first
+    uint32_t select(const Node &node, double exploration) const {
+        double logVisits = log((double)node.visits.load(std::memory_order_relaxed));
+        uint32_t best = node.firstChild;
+        double bestScore = -1;
+        for (uint32_t i = node.firstChild; i < node.firstChild + node.numChildren; i++) {
+            const Node &child = m_nodes[i];
+            uint32_t visits = child.visits.load(std::memory_order_relaxed);
+            if (visits == 0)
+                return i;
+            double mean = child.reward.load(std::memory_order_relaxed) / (REWARD_ONE * visits);
+            double score = mean + exploration * sqrt(logVisits / visits);
+            if (score > bestScore) {
+                bestScore = score;
+                best = i;
+            }
+        }
+        return best;
+    }
+
+    // Add the children of a node this thread has claimed; false if it has none
+    bool expand(Node &node, const Position &pos, std::vector<MoveType> &moves) {
+        game.moves(pos, moves);
+        size_t first = moves.empty() ? 0 : m_used.fetch_add(moves.size());
+        if (moves.empty() || first + moves.size() > m_nodes.size()) {
+            node.state.store(NODE_FINAL, std::memory_order_release);
+            return false;
+        }
+        for (size_t i = 0; i < moves.size(); i++) {
+            Node &child = m_nodes[first + i];
+            child.visits.store(0, std::memory_order_relaxed);
+            child.reward.store(0, std::memory_order_relaxed);
+            child.state.store(NODE_LEAF, std::memory_order_relaxed);
+            child.numChildren = 0;
+            child.move = moves[i];
+        }
+        node.firstChild = (uint32_t)first;
+        node.numChildren = (uint32_t)moves.size();
+        node.state.store(NODE_EXPANDED, std::memory_order_release);
+        return true;
+    }
+
+    void descend(Worker &w, uint32_t index, uint32_t virtualLoss) {
+        w.path.push_back(index);
+        m_nodes[index].visits.fetch_add(virtualLoss, std::memory_order_relaxed);
+        if (index != 0) {
+            w.line.push_back(m_nodes[index].move);
+            game.apply(w.pos, m_nodes[index].move);
+        }
+    }
+
+    // One selection, expansion, playout and backup
+    void iterate(Worker &w, const MctsOptions &options) {
+        uint32_t virtualLoss = options.virtualLoss < 1 ? 1 : options.virtualLoss;
+        w.pos = m_root;
+        w.path.clear();
+        w.line.clear();
+
+        descend(w, 0, virtualLoss);
+        while (true) {
+            Node &node = m_nodes[w.path.back()];
+            uint8_t state = node.state.load(std::memory_order_acquire);
+            if (state == NODE_EXPANDED) {
+                descend(w, select(node, options.exploration), virtualLoss);
+                continue;
+            }
+            // Another thread busy expanding the node counts as a leaf
+            uint8_t leaf = NODE_LEAF;
+            if (state == NODE_LEAF && node.state.compare_exchange_strong(leaf, NODE_EXPANDING) &&
+                expand(node, w.pos, w.moves))
+                descend(w, select(node, options.exploration), virtualLoss);
+            break;
+        }
+
+        // Playout
+        while (true) {
+            game.moves(w.pos, w.moves);
+            if (w.moves.empty())
+                break;
+            size_t k = w.next(w.moves.size());
+            if (options.heuristicPlayouts && w.moves.size() > 1) {
+                size_t other = w.next(w.moves.size());
+                if (game.centreGain(w.moves[other]) > game.centreGain(w.moves[k]))
+                    k = other;
+            }
+            game.apply(w.pos, w.moves[k]);
+            w.line.push_back(w.moves[k]);
+        }
+
+        int pegs = game.pegs(w.pos);
+        double reward = m_rootPegs > 1 ? (double)(m_rootPegs - pegs) / (m_rootPegs - 1) : 1.0;
+        uint64_t fixed = (uint64_t)(reward * REWARD_ONE);
+        for (size_t i = 0; i < w.path.size(); i++) {
+            Node &node = m_nodes[w.path[i]];
+            node.visits.fetch_add(1 - virtualLoss, std::memory_order_relaxed);
+            node.reward.fetch_add(fixed, std::memory_order_relaxed);
+        }
+
+        if (pegs < m_bestPegs.load(std::memory_order_relaxed)) {
+            std::lock_guard<std::mutex> lock(m_bestMutex);
+            if (pegs < m_bestPegs.load(std::memory_order_relaxed)) {
+                m_bestLine = w.line;
+                m_bestPegs.store(pegs);
+            }
+        }
+    }
+
+    std::vector<Node> m_nodes;      // Pool; node 0 is the root
+    std::atomic<size_t> m_used;     // Nodes handed out, may run past the pool size
+    Position m_root;
+    int m_rootPegs;
+    size_t m_rootMoves;
+    std::atomic<int> m_bestPegs;
+    std::mutex m_bestMutex;         // Guards m_bestLine while threads search
+    std::vector<MoveType> m_bestLine;
+    MctsStats m_stats;
+};
+
+template <class Game>
+void MctsTree<Game>::search(const MctsOptions &options) {
+    if (m_rootMoves == 0 || (options.seconds <= 0 && options.playouts == 0))
+        return;
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    std::atomic<uint64_t> started(0);
+    std::atomic<bool> stop(false);
+
+    auto work = [&](int t) {
+        Worker w;
+        w.random = splitMix64(options.seed + (uint64_t)t * 0x100000001ull + m_stats.playouts);
+        for (int i = 0; !stop.load(std::memory_order_relaxed); i++) {
+            if (options.playouts && started.fetch_add(1) >= options.playouts)
+                break;
+            iterate(w, options);
+            if (m_bestPegs.load(std::memory_order_relaxed) == 1)
+                stop = true;
+            if (options.seconds > 0 && i % 16 == 15 &&
+                std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count() >= options.seconds)
+                stop = true;
+        }
+    };
+    uint64_t before = m_nodes[0].visits.load();
+    runThreads(options.threads, work);
+
+    // Every finished playout went through the root once
+    m_stats.playouts += m_nodes[0].visits.load() - before;
+    m_stats.nodes = std::min(m_used.load(), m_nodes.size());
+    m_stats.bestPegs = m_bestPegs.load();
+    m_stats.seconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+/* ################################################################# */
+// Players //
+
+MctsPlayer::MctsPlayer(size_t maxNodes) : m_tree(new MctsTree<BitboardMctsGame>(maxNodes)) {
+    m_board = GEOMETRY_ENGLISH;
+    m_tree->game.setBoard(m_board);
+    m_tree->setPosition(getGeometry(m_board).allHoles & ~bbBit(getGeometry(m_board).defaultEmpty), false);
+}
+
+MctsPlayer::~MctsPlayer() {
+    delete m_tree;
+}
+
+void MctsPlayer::setPosition(GeometryId id, Bitboard pegs) {
+    bool sameBoard = id == m_board;
+    if (!sameBoard) {
+        m_board = id;
+        m_tree->game.setBoard(id);
+    }
+    m_tree->setPosition(pegs & getGeometry(id).allHoles, sameBoard);
+}
+
+void MctsPlayer::search(const MctsOptions &options) { m_tree->search(options); }
+bool MctsPlayer::bestMove(Move &m) const { return m_tree->bestMove(m); }
+const std::vector<Move> &MctsPlayer::bestLine() const { return m_tree->bestLine(); }
+const MctsStats &MctsPlayer::stats() const { return m_tree->stats(); }
+
+WideMctsPlayer::WideMctsPlayer(size_t maxNodes) : m_tree(new MctsTree<WideMctsGame>(maxNodes)) {
+    WideBoard empty(1, 1);
+    m_tree->game.setBoard(empty);
+    m_tree->setPosition(empty, false);
+}
+
+WideMctsPlayer::~WideMctsPlayer() {
+    delete m_tree;
+}
+
+void WideMctsPlayer::setPosition(const WideBoard &board) {
+    m_tree->game.setBoard(board);
+    m_tree->setPosition(board, true);
+}
+
+void WideMctsPlayer::search(const MctsOptions &options) { m_tree->search(options); }
+bool WideMctsPlayer::bestMove(WideMove &m) const { return m_tree->bestMove(m); }
+const std::vector<WideMove> &WideMctsPlayer::bestLine() const { return m_tree->bestLine(); }
+const MctsStats &WideMctsPlayer::stats() const { return m_tree->stats(); }
@@ -0,0 +1,244 @@
+#include <algorithm>
+#include <chrono>
+#include "move_solver.h"
+#include "pruning.h"
+#include "static_engine.h"
+
+// Low bits of a bound table slot holding the position
+static const uint64_t SLOT_POSITION_MASK = ((uint64_t)1 << 56) - 1;
+
+/* ################################################################# */
+// Bound table //
+
+MoveBoundTable::MoveBoundTable(int log2Slots) : m_slots((size_t)1 << log2Slots) {
+    m_mask = m_slots.size() - 1;
+    clear();
+}
+
+void MoveBoundTable::clear() {
+    std::fill(m_slots.begin(), m_slots.end(), 0);
+}
+
+int MoveBoundTable::lookup(uint64_t key, Bitboard pegs) const {
+    for (int p = 0; p < PROBES; p++) {
+        uint64_t slot = m_slots[(key + p) & m_mask];
+        if ((slot & SLOT_POSITION_MASK) == pegs)
+            return (int)(slot >> 56);
+        if (slot == 0)
+            return 0;
+    }
+    return 0;
+}
+
+void MoveBoundTable::store(uint64_t key, Bitboard pegs, int moves) {
+    uint64_t entry = pegs | (uint64_t)moves << 56;
+    for (int p = 0; p < PROBES; p++) {
+        uint64_t &slot = m_slots[(key + p) & m_mask];
+        if (slot == 0 || (slot & SLOT_POSITION_MASK) == pegs) {
+            slot = entry;
+            return;
+        }
+    }
+    // Window full: replace the home slot
+    m_slots[key & m_mask] = entry;
+}
+
+int countChainMoves(const Geometry &geo, const std::vector<Move> &line) {
+    int moves = 0;
+    int landed = -1;
+    for (size_t i = 0; i < line.size(); i++) {
+        moves += line[i].from != landed;
+        landed = moveJump(geo, line[i]).to;
+    }
+    return moves;
+}
+
+/* ################################################################# */
+// Search //
+
+template <GeometryId G>
+struct MoveSearch {
+    typedef StaticEngine<G> Engine;
+
+    static const int FOUND = -1;
+
+    MoveBoundTable &bounds;
+    MoveSolverStats &stats;
+    Bitboard goal;          // Holes the last peg may end on
+    uint32_t symmetries;    // Symmetries that preserve the goal
+    bool anyHole;           // No target: symmetries holds all of them
+    Bitboard corners;       // Holes never jumped over
+    PagodaCuts pagodas;
+    uint64_t nodeLimit;
+    bool aborted;
+    int budget;             // Moves allowed in the current iteration
+    std::vector<Move> &line;  // Filled in reverse on the way back up
+
+    Bitboard canonical(Bitboard pegs) const {
+        if (anyHole)
+            return Engine::canonical(pegs);
+        return Engine::canonical(pegs, symmetries);
+    }
+
+    // Moves still needed from a position of more than one peg. A peg on
+    // the target hole may stay there; without a target the last peg may be
+    // any one of the pegs counted, which then never has to move.
+    int lowerBound(Bitboard pegs) const {
+        int moves = anyHole ? cornerMoves(corners, pegs) - 1 : cornerMoves(corners, pegs & ~goal);
+        return std::max(moves, 1);
+    }
+
+    // A chain that just made jump j: the move may end here or go on with
+    // another jump of the same peg. Returns FOUND or the least estimate
+    // past the budget, like search().
+    int follow(Bitboard pegs, int pegCount, int played, const Jump &j) {
+        Bitboard next = pegs ^ j.mask;
+        int least = search(next, pegCount - 1, played + 1);
+        for (int d = 0; d < Engine::geo.numDirections && least != FOUND && !aborted; d++) {
+            int k = Engine::geo.jumpIndex[j.to][d];
+            if (k < 0)
+                continue;
+            const Jump &jump = Engine::geo.jumps[k];
+            if (bbTest(next, jump.over) && !bbTest(next, jump.to))
+                least = std::min(least, follow(next, pegCount - 1, played, jump));
+        }
+        if (least == FOUND) {
+            Move m = { j.from, j.dir };
+            line.push_back(m);
+        }
+        return least;
+    }
+
+    // Moves played plus the estimate of the moves left, at the first
+    // positions past the budget (MOVES_UNREACHABLE if the goal cannot be
+    // reached), or FOUND with the line filled in
+    int search(Bitboard pegs, int pegCount, int played) {
+        if (pegCount == 1)
+            return (pegs & goal) != 0 ? FOUND : MOVES_UNREACHABLE;
+        // The corner count alone cuts most positions, before the cost of
+        // canonicalizing them for the table
+        int estimate = lowerBound(pegs);
+        if (played + estimate > budget)
+            return played + estimate;
+        if (pagodas.below(pegs))
+            return MOVES_UNREACHABLE;
+        Bitboard canon = canonical(pegs);
+        uint64_t key = splitMix64(canon);
+        int learned = bounds.lookup(key, canon);
+        if (learned > estimate) {
+            stats.tableHits++;
+            estimate = learned;
+        }
+        if (estimate == MOVES_UNREACHABLE)
+            return MOVES_UNREACHABLE;
+        if (played + estimate > budget)
+            return played + estimate;
+        if (nodeLimit && stats.nodes >= nodeLimit) {
+            aborted = true;
+            return MOVES_UNREACHABLE;
+        }
+        stats.nodes++;
+
+        int least = MOVES_UNREACHABLE;
+        Move moves[MAX_JUMPS];
+        int n = Engine::generateMoves(pegs, moves);
+        for (int i = 0; i < n; i++) {
+            int result = follow(pegs, pegCount, played, moveJump(Engine::geo, moves[i]));
+            if (result == FOUND)
+                return FOUND;
+            if (aborted)
+                return MOVES_UNREACHABLE;
+            least = std::min(least, result);
+        }
+        // Every line from here needs at least least - played moves
+        bounds.store(key, canon, least == MOVES_UNREACHABLE ? MOVES_UNREACHABLE : least - played);
+        return least;
+    }
+
+    static SolveResult run(MoveBoundTable &bounds, MoveSolverStats &stats, Bitboard pegs, int targetHole,
+                           int upperBound, uint64_t nodeLimit, std::vector<Move> &line) {
+        const Geometry &geo = Engine::geo;
+        pegs &= Engine::HOLES;
+        Bitboard goal = targetHole >= 0 ? bbBit(targetHole) : Engine::HOLES;
+        uint32_t symmetries = targetHole >= 0 ? symmetriesFixing(geo, targetHole) : allSymmetries(geo);
+        MoveSearch s = { bounds, stats, goal, symmetries, targetHole < 0, cornerHoles(geo), {},
+                         nodeLimit, false, 0, line };
+
+        // The same cuts as Solver: the last peg can only stand on a hole of
+        // the start's class, and pagodas must not fall below the goal's
+        s.goal = classGoal(geo, pegs, s.goal);
+        s.pagodas = goalPagodas(geo, s.goal);
+
+        // Each iteration raises the budget to the least estimate that
+        // exceeded the last one, until a line fits. A bound learned by an
+        // earlier call lets the first iteration start higher.
+        int pegCount = bbPopCount(pegs);
+        Bitboard canon = s.canonical(pegs);
+        int next = pegCount == 1 ? 0 : std::max(s.lowerBound(pegs), bounds.lookup(splitMix64(canon), canon));
+        while (next < upperBound) {
+            s.budget = next;
+            stats.bound = next;
+            stats.iterations++;
+            line.clear();
+            int result = s.search(pegs, pegCount, 0);
+            if (result == FOUND) {
+                std::reverse(line.begin(), line.end());
+                return SOLVE_WIN;
+            }
+            if (s.aborted)
+                return SOLVE_UNKNOWN;
+            next = result;
+        }
+        // No line shorter than upperBound
+        stats.bound = upperBound;
+        return SOLVE_DEAD;
+    }
+};
+
+/* ################################################################# */
+// Solver //
+
+MoveSolver::MoveSolver(int log2TableSlots) : m_bounds(log2TableSlots) {
+    m_tableBoard = GEOMETRY_ENGLISH;
+    m_tableTarget = -1;
+    m_stats = MoveSolverStats();
+}
+
+void MoveSolver::clear() {
+    m_bounds.clear();
+    m_solver.clear();
+}
+
+SolveResult MoveSolver::solve(GeometryId id, Bitboard pegs, std::vector<Move> &line, int targetHole,
+                              uint64_t nodeLimit) {
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    const Geometry &geo = getGeometry(id);
+    if (targetHole >= geo.numHoles)
+        targetHole = -1;
+    if (id != m_tableBoard || targetHole != m_tableTarget) {
+        m_bounds.clear();
+        m_tableBoard = id;
+        m_tableTarget = targetHole;
+    }
+    m_stats = MoveSolverStats();
+    line.clear();
+
+    // Any winning line gives an upper bound, and proves there is a line at
+    // all before the iterations start
+    std::vector<Move> first;
+    SolveResult result = m_solver.solve(id, pegs, first, targetHole, nodeLimit);
+    if (result == SOLVE_WIN) {
+        uint64_t used = m_solver.stats().nodes;
+        uint64_t remaining = nodeLimit ? (nodeLimit > used ? nodeLimit - used : 1) : 0;
+        result = dispatchGeometry<MoveSearch>(id, m_bounds, m_stats, pegs, targetHole,
+                                              countChainMoves(geo, first), remaining, line);
+        // The budget reached the first line's length without a shorter
+        // line turning up, so that line is a shortest one
+        if (result == SOLVE_DEAD) {
+            line = first;
+            result = SOLVE_WIN;
+        }
+    }
+    m_stats.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return result;
+}
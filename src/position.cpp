@@ -0,0 +1,41 @@
+#include "position.h"
+
+bool parsePosition(const Geometry &geo, const char *text, Bitboard &pegs) {
+    Bitboard parsed = 0;
+    const char *p = text;
+    for (int r = 0; r < geo.rows; r++) {
+        if (r > 0 && *p++ != '/')
+            return false;
+        for (int c = 0; c < geo.cols; c++, p++) {
+            int hole = geo.holeAt[r][c];
+            if (hole < 0) {
+                if (*p != '.')
+                    return false;
+            } else if (*p == 'o') {
+                parsed |= (Bitboard)1 << hole;
+            } else if (*p != '_') {
+                return false;
+            }
+        }
+    }
+    if (*p != '\0')
+        return false;
+    pegs = parsed;
+    return true;
+}
+
+std::string formatPosition(const Geometry &geo, Bitboard pegs) {
+    std::string text;
+    for (int r = 0; r < geo.rows; r++) {
+        if (r > 0)
+            text += '/';
+        for (int c = 0; c < geo.cols; c++) {
+            int hole = geo.holeAt[r][c];
+            if (hole < 0)
+                text += '.';
+            else
+                text += (pegs >> hole) & 1 ? 'o' : '_';
+        }
+    }
+    return text;
+}
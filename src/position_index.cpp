@@ -0,0 +1,327 @@
+#include <stdio.h>
+#include <string.h>
+#include <algorithm>
+#include <utility>
+#include <vector>
+#include "position_index.h"
+#include "position_layers.h"
+
+static const char INDEX_MAGIC[8] = "POSIDX2";
+
+// Fields of a PositionRecord
+static const int RECORD_FEWEST_SHIFT = 10;
+static const uint32_t RECORD_COUNT_MASK = (1 << RECORD_FEWEST_SHIFT) - 1;
+static const uint32_t RECORD_FEWEST_MASK = 63;
+static const int RECORD_FINGERPRINT_SHIFT = 16;
+// Count field of a record whose count is in the overflow table
+static const uint32_t RECORD_COUNT_OVERFLOW = RECORD_COUNT_MASK;
+
+// 16 bits of a canonical position, independent of the hash levels
+static inline uint32_t fingerprint(Bitboard key) {
+    return (uint32_t)(splitMix64(key ^ 0x9E3779B97F4A7C15ULL) >> 48);
+}
+
+// Bytes of n 32-bit entries padded to whole 64-bit words
+static inline uint64_t paddedWords32(uint64_t n) {
+    return (n + 1) / 2 * sizeof(uint64_t);
+}
+
+/* ################################################################# */
+// Hash //
+
+// Bit of a key in a level's array of the given size; each level mixes the
+// key with a different constant so that colliding keys part on the next one
+static inline uint64_t levelBit(Bitboard key, int level, uint64_t bits) {
+    uint64_t h = splitMix64(key + ((uint64_t)(level + 1) << 56));
+    return (uint64_t)(((unsigned __int128)h * bits) >> 64);
+}
+
+// The hash in memory, either as built or as mapped from a file
+struct HashView {
+    const uint64_t *levelStart; // numLevels + 1 offsets, in bits
+    int numLevels;
+    const uint64_t *bits;
+    const uint64_t *ranks;
+    const Bitboard *fallback;   // Sorted
+    uint32_t numFallback;
+    uint64_t numRanked;         // Keys placed in the levels
+
+    int64_t slot(Bitboard key) const {
+        for (int level = 0; level < numLevels; level++) {
+            uint64_t pos = levelStart[level] + levelBit(key, level, levelStart[level + 1] - levelStart[level]);
+            uint64_t word = pos >> 6;
+            if (!((bits[word] >> (pos & 63)) & 1))
+                continue;
+            uint64_t rank = ranks[word >> 3];
+            for (uint64_t w = word & ~(uint64_t)7; w < word; w++)
+                rank += bbPopCount(bits[w]);
+            return rank + bbPopCount(bits[word] & (bbBit(pos & 63) - 1));
+        }
+        const Bitboard *end = fallback + numFallback;
+        const Bitboard *found = std::lower_bound(fallback, end, key);
+        if (found == end || *found != key)
+            return -1;
+        return numRanked + (found - fallback);
+    }
+};
+
+// Number of running-count entries for the given number of level words
+static inline size_t rankCount(uint64_t words) {
+    return (size_t)(words + 7) / 8 + 1;
+}
+
+struct HashTables {
+    std::vector<uint32_t> levelWords;
+    std::vector<uint64_t> levelStart;
+    std::vector<uint64_t> bits;
+    std::vector<uint64_t> ranks;
+    std::vector<Bitboard> fallback;
+
+    HashView view() const {
+        HashView v = { levelStart.data(), (int)levelWords.size(), bits.data(), ranks.data(),
+                       fallback.data(), (uint32_t)fallback.size(), (uint64_t)0 };
+        v.numRanked = ranks.back();
+        return v;
+    }
+};
+
+// Build the minimal perfect hash of a set of distinct keys
+static void buildHash(std::vector<Bitboard> keys, HashTables &hash) {
+    hash.levelStart.push_back(0);
+    for (int level = 0; level < MAX_INDEX_LEVELS && !keys.empty(); level++) {
+        // Two bits per key leave most keys alone in their bit
+        uint64_t words = (2 * (uint64_t)keys.size() + 63) / 64;
+        uint64_t size = words * 64;
+        std::vector<uint64_t> seen(words, 0), collided(words, 0);
+        for (size_t i = 0; i < keys.size(); i++) {
+            uint64_t pos = levelBit(keys[i], level, size);
+            if (seen[pos >> 6] & bbBit(pos & 63))
+                collided[pos >> 6] |= bbBit(pos & 63);
+            seen[pos >> 6] |= bbBit(pos & 63);
+        }
+
+        // Colliding keys move on to the next level
+        size_t remaining = 0;
+        for (size_t i = 0; i < keys.size(); i++) {
+            uint64_t pos = levelBit(keys[i], level, size);
+            if (collided[pos >> 6] & bbBit(pos & 63))
+                keys[remaining++] = keys[i];
+        }
+        keys.resize(remaining);
+        for (uint64_t w = 0; w < words; w++)
+            hash.bits.push_back(seen[w] & ~collided[w]);
+        hash.levelWords.push_back((uint32_t)words);
+        hash.levelStart.push_back(hash.levelStart.back() + size);
+    }
+    std::sort(keys.begin(), keys.end());
+    hash.fallback = keys;
+
+    hash.ranks.assign(rankCount(hash.bits.size()), 0);
+    uint64_t rank = 0;
+    for (size_t w = 0; w < hash.bits.size(); w++) {
+        if (w % 8 == 0)
+            hash.ranks[w / 8] = rank;
+        rank += bbPopCount(hash.bits[w]);
+    }
+    hash.ranks.back() = rank;
+}
+
+/* ################################################################# */
+// Reading //
+
+PositionIndex::PositionIndex() {
+    m_header = NULL;
+    m_symmetries = 0;
+    m_bits = NULL;
+    m_ranks = NULL;
+    m_fallback = NULL;
+    m_records = NULL;
+    m_overflowSlots = NULL;
+    m_overflowCounts = NULL;
+}
+
+bool PositionIndex::open(const char *path) {
+    close();
+    if (!m_file.open(path))
+        return false;
+
+    const PositionIndexHeader *header = (const PositionIndexHeader *)m_file.data();
+    bool valid = m_file.size() >= sizeof(PositionIndexHeader) &&
+                 memcmp(header->magic, INDEX_MAGIC, sizeof(INDEX_MAGIC)) == 0 && header->board < NUM_GEOMETRIES &&
+                 header->startHole < (uint32_t)getGeometry((GeometryId)header->board).numHoles &&
+                 header->numLevels <= (uint32_t)MAX_INDEX_LEVELS && header->numFallback <= header->numKeys;
+    uint64_t words = 0;
+    for (uint32_t level = 0; valid && level < header->numLevels; level++) {
+        m_levelStart[level] = words * 64;
+        words += header->levelWords[level];
+    }
+    m_levelStart[valid ? header->numLevels : 0] = words * 64;
+    uint64_t keys = valid ? header->numKeys : 0;
+    uint64_t overflow = valid && header->numOverflow <= header->numKeys ? header->numOverflow : 0;
+    uint64_t expected = sizeof(PositionIndexHeader) +
+                        (words + rankCount(words) + (valid ? header->numFallback : 0)) * sizeof(uint64_t) +
+                        paddedWords32(keys) + paddedWords32(overflow) + overflow * sizeof(uint64_t);
+    if (!valid || header->numOverflow > header->numKeys || m_file.size() != expected) {
+        printf("%s: not a position index\n", path);
+        m_file.close();
+        return false;
+    }
+    m_header = header;
+    m_symmetries = symmetriesFixing(getGeometry(board()), startHole());
+    m_bits = (const uint64_t *)(header + 1);
+    m_ranks = m_bits + words;
+    m_fallback = m_ranks + rankCount(words);
+    m_records = (const PositionRecord *)(m_fallback + header->numFallback);
+    m_overflowSlots = (const uint32_t *)((const char *)m_records + paddedWords32(keys));
+    m_overflowCounts = (const uint64_t *)((const char *)m_overflowSlots + paddedWords32(overflow));
+    return true;
+}
+
+void PositionIndex::close() {
+    m_file.close();
+    m_header = NULL;
+    m_bits = NULL;
+    m_ranks = NULL;
+    m_fallback = NULL;
+    m_records = NULL;
+    m_overflowSlots = NULL;
+    m_overflowCounts = NULL;
+}
+
+int64_t PositionIndex::slot(Bitboard canonical) const {
+    HashView hash = { m_levelStart, (int)m_header->numLevels, m_bits, m_ranks, m_fallback,
+                      m_header->numFallback, m_header->numKeys - m_header->numFallback };
+    return hash.slot(canonical);
+}
+
+bool PositionIndex::lookup(Bitboard pegs, PositionInfo &info) const {
+    Bitboard canonical = getEngineOps(board()).canonicalUnder(pegs, m_symmetries);
+    int64_t s = slot(canonical);
+    if (s < 0)
+        return false;
+    PositionRecord record = m_records[s];
+    if (record >> RECORD_FINGERPRINT_SHIFT != fingerprint(canonical))
+        return false;
+    info.fewestPegs = (int)(record >> RECORD_FEWEST_SHIFT & RECORD_FEWEST_MASK);
+    info.solutions = record & RECORD_COUNT_MASK;
+    if (info.solutions == RECORD_COUNT_OVERFLOW) {
+        const uint32_t *end = m_overflowSlots + m_header->numOverflow;
+        const uint32_t *found = std::lower_bound(m_overflowSlots, end, (uint32_t)s);
+        info.solutions = m_overflowCounts[found - m_overflowSlots];
+    }
+    return true;
+}
+
+/* ################################################################# */
+// Building //
+
+// Fewest pegs and solutions of a position
+struct PositionValue {
+    uint64_t fewest;
+    uint64_t solutions;
+};
+
+template <GeometryId G>
+struct PositionIndexBuilder {
+    typedef StaticEngine<G> Engine;
+
+    static bool run(int emptyHole, const char *path, PositionIndexProgress progress, void *user) {
+        PositionLayers<G> layers(symmetriesFixing(Engine::geo, emptyHole), 1);
+        layers.enumerate(initialBoard(Engine::geo, emptyHole).pegs, [](Bitboard) { return true; }, [&](int l) {
+            if (progress)
+                progress("reached", l, layers.layers[l].size(), user);
+        });
+
+        std::vector<Bitboard> keys;
+        for (size_t l = 0; l < layers.layers.size(); l++)
+            keys.insert(keys.end(), layers.layers[l].begin(), layers.layers[l].end());
+        size_t numKeys = keys.size();
+        HashTables hash;
+        buildHash(std::move(keys), hash);
+        if (progress)
+            progress("hashed", -1, numKeys, user);
+
+        // Fill the records from the last layer back to the start; solution
+        // counts saturate, and those too large for a record go to the
+        // overflow table, sorted by slot afterwards
+        HashView view = hash.view();
+        Bitboard goal = bbBit(emptyHole);
+        std::vector<PositionRecord> records(numKeys + 1, 0);
+        std::vector<std::pair<uint32_t, uint64_t> > overflow;
+        layers.backward(
+            [&](Bitboard pegs) {
+                PositionValue v = { (uint64_t)bbPopCount(pegs), (uint64_t)(pegs == goal) };
+                return v;
+            },
+            [](PositionValue &v, const PositionValue &child) {
+                v.fewest = std::min(v.fewest, child.fewest);
+                if (__builtin_add_overflow(v.solutions, child.solutions, &v.solutions))
+                    v.solutions = UINT64_MAX;
+            },
+            [&](int l, const std::vector<PositionValue> &values) {
+                const std::vector<Bitboard> &layer = layers.layers[l];
+                for (size_t i = 0; i < layer.size(); i++) {
+                    int64_t slot = view.slot(layer[i]);
+                    uint32_t count = RECORD_COUNT_OVERFLOW;
+                    if (values[i].solutions < RECORD_COUNT_OVERFLOW)
+                        count = (uint32_t)values[i].solutions;
+                    else
+                        overflow.push_back(std::make_pair((uint32_t)slot, values[i].solutions));
+                    records[slot] = fingerprint(layer[i]) << RECORD_FINGERPRINT_SHIFT |
+                                    (uint32_t)values[i].fewest << RECORD_FEWEST_SHIFT | count;
+                }
+                if (progress)
+                    progress("solved", l, layer.size(), user);
+            });
+        std::sort(overflow.begin(), overflow.end());
+        std::vector<uint32_t> overflowSlots;
+        std::vector<uint64_t> overflowCounts;
+        for (size_t k = 0; k < overflow.size(); k++) {
+            overflowSlots.push_back(overflow[k].first);
+            overflowCounts.push_back(overflow[k].second);
+        }
+        overflowSlots.push_back(0);
+
+        PositionIndexHeader header;
+        memset(&header, 0, sizeof(header));
+        memcpy(header.magic, INDEX_MAGIC, sizeof(INDEX_MAGIC));
+        header.board = G;
+        header.startHole = emptyHole;
+        header.numKeys = numKeys;
+        header.numLevels = (uint32_t)hash.levelWords.size();
+        header.numFallback = (uint32_t)hash.fallback.size();
+        header.numOverflow = overflowCounts.size();
+        for (size_t level = 0; level < hash.levelWords.size(); level++)
+            header.levelWords[level] = hash.levelWords[level];
+
+        FILE *f = fopen(path, "wb");
+        if (!f) {
+            printf("Cannot write %s\n", path);
+            return false;
+        }
+        bool written = fwrite(&header, sizeof(header), 1, f) == 1 &&
+                       fwrite(hash.bits.data(), sizeof(uint64_t), hash.bits.size(), f) == hash.bits.size() &&
+                       fwrite(hash.ranks.data(), sizeof(uint64_t), hash.ranks.size(), f) == hash.ranks.size() &&
+                       fwrite(hash.fallback.data(), sizeof(Bitboard), hash.fallback.size(), f) ==
+                           hash.fallback.size() &&
+                       fwrite(records.data(), 1, paddedWords32(numKeys), f) == paddedWords32(numKeys) &&
+                       fwrite(overflowSlots.data(), 1, paddedWords32(overflowCounts.size()), f) ==
+                           paddedWords32(overflowCounts.size()) &&
+                       fwrite(overflowCounts.data(), sizeof(uint64_t), overflowCounts.size(), f) ==
+                           overflowCounts.size();
+        written = fclose(f) == 0 && written;
+        if (!written)
+            printf("Cannot write %s\n", path);
+        return written;
+    }
+};
+
+bool buildPositionIndex(GeometryId id, int emptyHole, const char *path,
+                        PositionIndexProgress progress, void *user) {
+    const Geometry &geo = getGeometry(id);
+    if (emptyHole < 0 || emptyHole >= geo.numHoles) {
+        printf("The %s board has no hole %d\n", geo.name, emptyHole);
+        return false;
+    }
+    return dispatchGeometry<PositionIndexBuilder>(id, emptyHole, path, progress, user);
+}
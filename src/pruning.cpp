@@ -0,0 +1,201 @@
+#include <algorithm>
+#include "pruning.h"
+#include "geometry_tables.h"
+
+/* ################################################################# */
+// Pagoda layouts, in the board's grid: '.' is not a hole, '-' weighs -1 //
+
+// Picked greedily on dead positions of the English central game: the
+// first alone cuts over half of them, the other two most of the rest
+constexpr const char *ENGLISH_PAGODA_CROSS[] = {
+    "..-0-..",
+    "..111..",
+    "-10101-",
+    "0111110",
+    "-10101-",
+    "..111..",
+    "..-0-..",
+    nullptr
+};
+
+constexpr const char *ENGLISH_PAGODA_BARS[] = {
+    "..-0-..",
+    "..111..",
+    "0000000",
+    "0111110",
+    "0000000",
+    "..111..",
+    "..-0-..",
+    nullptr
+};
+
+constexpr const char *ENGLISH_PAGODA_SPOKES[] = {
+    "..000..",
+    "..010..",
+    "-10101-",
+    "0101010",
+    "-10101-",
+    "..010..",
+    "..000..",
+    nullptr
+};
+
+struct PagodaSpec {
+    GeometryId board;
+    const char *const *layout;
+};
+
+constexpr PagodaSpec PAGODA_SPECS[] = {
+    { GEOMETRY_ENGLISH, ENGLISH_PAGODA_CROSS },
+    { GEOMETRY_ENGLISH, ENGLISH_PAGODA_BARS },
+    { GEOMETRY_ENGLISH, ENGLISH_PAGODA_SPOKES },
+};
+
+const int NUM_PAGODA_SPECS = sizeof(PAGODA_SPECS) / sizeof(PAGODA_SPECS[0]);
+
+struct PagodaWeights {
+    int8_t weight[MAX_HOLES];
+    bool matches;  // Layout has the board's shape
+};
+
+constexpr PagodaWeights parsePagoda(const Geometry &geo, const char *const *layout) {
+    PagodaWeights p{};
+    p.matches = true;
+    int seen = 0;
+    for (int r = 0; layout[r] != nullptr; r++) {
+        for (int c = 0; layout[r][c] != '\0'; c++) {
+            char ch = layout[r][c];
+            int h = holeIndex(geo, r, c);
+            if ((ch == '.') != (h < 0) || (ch != '.' && ch != '-' && (ch < '0' || ch > '3'))) {
+                p.matches = false;
+                return p;
+            }
+            if (h >= 0) {
+                p.weight[h] = (int8_t)(ch == '-' ? -1 : ch - '0');
+                seen++;
+            }
+        }
+    }
+    p.matches = seen == geo.numHoles;
+    return p;
+}
+
+constexpr bool isPagoda(const Geometry &geo, const PagodaWeights &p) {
+    if (!p.matches)
+        return false;
+    for (int i = 0; i < geo.numJumps; i++) {
+        const Jump &j = geo.jumps[i];
+        if (p.weight[j.from] + p.weight[j.over] < p.weight[j.to])
+            return false;
+    }
+    return true;
+}
+
+constexpr bool allPagodasValid() {
+    for (int i = 0; i < NUM_PAGODA_SPECS; i++) {
+        const Geometry &geo = GEOMETRY_TABLE[PAGODA_SPECS[i].board];
+        if (!isPagoda(geo, parsePagoda(geo, PAGODA_SPECS[i].layout)))
+            return false;
+    }
+    return true;
+}
+
+static_assert(allPagodasValid(), "A tabulated pagoda does not fit its board or lets some jump gain weight");
+
+/* ################################################################# */
+
+std::vector<Pagoda> boardPagodas(const Geometry &geo) {
+    std::vector<Pagoda> pagodas;
+    for (int i = 0; i < NUM_PAGODA_SPECS; i++) {
+        if (PAGODA_SPECS[i].board != geo.id)
+            continue;
+        PagodaWeights p = parsePagoda(geo, PAGODA_SPECS[i].layout);
+        for (int s = 0; s < geo.numSymmetries; s++) {
+            Pagoda image = { 0, 0, 0 };
+            for (int h = 0; h < geo.numHoles; h++) {
+                Bitboard bit = bbBit(geo.symmetry[s][h]);
+                if (p.weight[h] < 0)
+                    image.minus |= bit;
+                if (p.weight[h] > 0 && (p.weight[h] & 1))
+                    image.ones |= bit;
+                if (p.weight[h] > 0 && (p.weight[h] & 2))
+                    image.twos |= bit;
+            }
+            bool known = false;
+            for (size_t k = 0; k < pagodas.size() && !known; k++) {
+                known = pagodas[k].ones == image.ones && pagodas[k].twos == image.twos &&
+                        pagodas[k].minus == image.minus;
+            }
+            if (!known)
+                pagodas.push_back(image);
+        }
+    }
+    return pagodas;
+}
+
+PagodaCuts goalPagodas(const Geometry &geo, Bitboard goal) {
+    PagodaCuts cuts;
+    std::vector<Pagoda> pagodas = boardPagodas(geo);
+    for (size_t k = 0; k < pagodas.size(); k++) {
+        int least = 1 << 30;
+        for (Bitboard g = goal; g; g &= g - 1)
+            least = std::min(least, pagodaValue(pagodas[k], bbBit(bbLowest(g))));
+        if (least > -bbPopCount(pagodas[k].minus)) {
+            cuts.pagodas.push_back(pagodas[k]);
+            cuts.least.push_back(least);
+        }
+    }
+    return cuts;
+}
+
+// Try the colourings (a*row + b*col) mod 3 and keep those where every
+// jump touches all three colours
+PositionClasses positionClasses(const Geometry &geo) {
+    static const int COEFFS[4][2] = { { 1, 0 }, { 0, 1 }, { 1, 1 }, { 1, 2 } };
+    PositionClasses pc = {};
+    for (int t = 0; t < 4 && pc.numColorings < 2; t++) {
+        int color[MAX_HOLES];
+        for (int h = 0; h < geo.numHoles; h++)
+            color[h] = (COEFFS[t][0] * geo.holeRow[h] + COEFFS[t][1] * geo.holeCol[h]) % 3;
+        bool valid = true;
+        for (int i = 0; i < geo.numJumps && valid; i++) {
+            const Jump &j = geo.jumps[i];
+            valid = color[j.from] != color[j.over] && color[j.over] != color[j.to] &&
+                    color[j.from] != color[j.to];
+        }
+        if (!valid)
+            continue;
+        Bitboard *masks = pc.color[pc.numColorings++];
+        for (int h = 0; h < geo.numHoles; h++)
+            masks[color[h]] |= bbBit(h);
+    }
+    return pc;
+}
+
+Bitboard classGoal(const Geometry &geo, Bitboard pegs, Bitboard goal) {
+    PositionClasses classes = positionClasses(geo);
+    int start = positionClass(classes, pegs);
+    for (Bitboard g = goal; g; g &= g - 1) {
+        if (positionClass(classes, bbBit(bbLowest(g))) != start)
+            goal &= ~bbBit(bbLowest(g));
+    }
+    return goal;
+}
+
+Bitboard symmetricGoal(const Geometry &geo, Bitboard goal, uint32_t symmetries) {
+    Bitboard images = 0;
+    for (int s = 0; s < geo.numSymmetries; s++) {
+        if (symmetries >> s & 1) {
+            for (Bitboard g = goal; g; g &= g - 1)
+                images |= bbBit(geo.symmetry[s][bbLowest(g)]);
+        }
+    }
+    return images;
+}
+
+Bitboard cornerHoles(const Geometry &geo) {
+    Bitboard jumped = 0;
+    for (int i = 0; i < geo.numJumps; i++)
+        jumped |= bbBit(geo.jumps[i].over);
+    return geo.allHoles & ~jumped;
+}
@@ -0,0 +1,124 @@
+#include <new>
+#include "solitaire.h"
+#include "game_state.h"
+
+static_assert(SOLITAIRE_MAX_MOVES >= MAX_JUMPS, "SOLITAIRE_MAX_MOVES too small");
+static_assert((int)SOLITAIRE_WON == (int)GAME_WON && (int)SOLITAIRE_LOST == (int)GAME_LOST,
+              "SolitaireStatus out of sync with GameStatus");
+
+struct SolitaireSession {
+    GameState state;
+
+    SolitaireSession(GeometryId id, int undoDepth) : state(id, undoDepth) {}
+};
+
+int solitaire_api_version(void) {
+    return SOLITAIRE_API_VERSION;
+}
+
+int solitaire_board_count(void) {
+    return NUM_GEOMETRIES;
+}
+
+const char *solitaire_board_name(int index) {
+    if (index < 0 || index >= NUM_GEOMETRIES)
+        return NULL;
+    return getGeometry((GeometryId)index).name;
+}
+
+// No exception may cross the C boundary, so allocation failures become NULL
+SolitaireSession *solitaire_create(const char *board, int undoDepth) {
+    GeometryId id = GEOMETRY_ENGLISH;
+    if (board && !findGeometry(board, id))
+        return NULL;
+    try {
+        return new SolitaireSession(id, undoDepth);
+    } catch (...) {
+        return NULL;
+    }
+}
+
+SolitaireSession *solitaire_clone(const SolitaireSession *session) {
+    try {
+        return new SolitaireSession(*session);
+    } catch (...) {
+        return NULL;
+    }
+}
+
+void solitaire_destroy(SolitaireSession *session) {
+    delete session;
+}
+
+void solitaire_new_game(SolitaireSession *session, int emptyHole) {
+    session->state.newGame(session->state.geometryId(), emptyHole);
+}
+
+const char *solitaire_board(const SolitaireSession *session) {
+    return session->state.geometry().name;
+}
+
+int solitaire_hole_count(const SolitaireSession *session) {
+    return session->state.geometry().numHoles;
+}
+
+int solitaire_hole_position(const SolitaireSession *session, int hole, int *row, int *col) {
+    const Geometry &geo = session->state.geometry();
+    if (hole < 0 || hole >= geo.numHoles)
+        return 0;
+    if (row)
+        *row = geo.holeRow[hole];
+    if (col)
+        *col = geo.holeCol[hole];
+    return 1;
+}
+
+int solitaire_peg_count(const SolitaireSession *session) {
+    return session->state.remainingPegs();
+}
+
+int solitaire_has_peg(const SolitaireSession *session, int hole) {
+    return session->state.holeState(hole) == FILLED;
+}
+
+uint64_t solitaire_pegs(const SolitaireSession *session) {
+    return session->state.board().pegs;
+}
+
+uint64_t solitaire_hash(const SolitaireSession *session) {
+    return session->state.hash();
+}
+
+SolitaireStatus solitaire_status(const SolitaireSession *session) {
+    return (SolitaireStatus)session->state.status();
+}
+
+int solitaire_legal_moves(const SolitaireSession *session, SolitaireMove *moves, int capacity) {
+    const GameState &state = session->state;
+    const Geometry &geo = state.geometry();
+    Move found[MAX_JUMPS];
+    int count = state.engine().generateMoves(state.board().pegs, found);
+    for (int i = 0; i < count && i < capacity; i++) {
+        const Jump &j = moveJump(geo, found[i]);
+        moves[i].from = j.from;
+        moves[i].over = j.over;
+        moves[i].to = j.to;
+    }
+    return count;
+}
+
+int solitaire_is_legal(const SolitaireSession *session, int from, int to) {
+    return session->state.isValidMove(from, to);
+}
+
+int solitaire_apply_move(SolitaireSession *session, int from, int to) {
+    return session->state.makeMove(from, to);
+}
+
+int solitaire_undo(SolitaireSession *session) {
+    return session->state.undo();
+}
+
+int solitaire_redo(SolitaireSession *session) {
+    return session->state.redo();
+}
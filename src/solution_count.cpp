@@ -0,0 +1,79 @@
+#include <algorithm>
+#include <chrono>
+#include <vector>
+#include "solution_count.h"
+#include "position_layers.h"
+#include "pruning.h"
+
+/* ################################################################# */
+// Counting //
+
+template <GeometryId G>
+struct SolutionCounter {
+    typedef StaticEngine<G> Engine;
+
+    static SolutionCount run(Bitboard pegs, int targetHole, int threads, SolutionCountStats &stats,
+                             SolutionCountProgress progress, void *user) {
+        const Geometry &geo = Engine::geo;
+        pegs &= Engine::HOLES;
+        uint32_t symmetries = targetHole >= 0 ? symmetriesFixing(geo, targetHole) : allSymmetries(geo);
+        Bitboard goal = targetHole >= 0 ? bbBit(targetHole) : Engine::HOLES;
+
+        // The last peg stands on a hole of the start's class, and pagodas
+        // never drop below their least value on a goal position. The layers
+        // hold canonical images, which may lie in another class than the
+        // start, so the goal is widened again to its images.
+        goal = symmetricGoal(geo, classGoal(geo, pegs, goal), symmetries);
+        if (goal == 0 || pegs == 0)
+            return 0;
+        PagodaCuts pagodas = goalPagodas(geo, goal);
+        if (pagodas.below(pegs))
+            return 0;
+
+        int startPegs = bbPopCount(pegs);
+        PositionLayers<G> layers(symmetries, threads);
+        layers.enumerate(pegs, [&](Bitboard child) { return !pagodas.below(child); }, [&](int l) {
+            uint64_t size = layers.layers[l].size();
+            stats.positions += size;
+            stats.widest = std::max(stats.widest, size);
+            if (progress)
+                progress("reached", startPegs - l, size, user);
+        });
+        stats.layers = (int)layers.layers.size();
+
+        // Sums stop at the largest count rather than wrap
+        return layers.backward(
+            [&](Bitboard p) { return (SolutionCount)(bbPopCount(p) == 1 && (p & goal) != 0); },
+            [](SolutionCount &total, SolutionCount child) {
+                if (__builtin_add_overflow(total, child, &total))
+                    total = SOLUTION_COUNT_MAX;
+            },
+            [&](int l, const std::vector<SolutionCount> &counts) {
+                if (progress)
+                    progress("counted", startPegs - l, counts.size(), user);
+            });
+    }
+};
+
+SolutionCount countSolutions(GeometryId id, Bitboard pegs, int targetHole, int threads, SolutionCountStats *stats,
+                             SolutionCountProgress progress, void *user) {
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    const Geometry &geo = getGeometry(id);
+    if (targetHole >= geo.numHoles)
+        targetHole = -1;
+    SolutionCountStats local = SolutionCountStats();
+    SolutionCount count = dispatchGeometry<SolutionCounter>(id, pegs, targetHole, threads, local, progress, user);
+    local.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    if (stats)
+        *stats = local;
+    return count;
+}
+
+std::string formatSolutionCount(SolutionCount count) {
+    std::string digits;
+    do {
+        digits.insert(digits.begin(), (char)('0' + (int)(count % 10)));
+        count /= 10;
+    } while (count);
+    return digits;
+}
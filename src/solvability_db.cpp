@@ -0,0 +1,174 @@
+#include <stdio.h>
+#include <string.h>
+#include <atomic>
+#include <vector>
+#include "solvability_db.h"
+#include "static_engine.h"
+#include "thread_utils.h"
+
+static const char DB_MAGIC[8] = "SOLVDB1";
+
+/* ################################################################# */
+// Reading //
+
+SolvabilityDb::SolvabilityDb() {
+    m_header = NULL;
+    m_bits = NULL;
+}
+
+bool SolvabilityDb::open(const char *path) {
+    close();
+    if (!m_file.open(path))
+        return false;
+
+    const SolvabilityDbHeader *header = (const SolvabilityDbHeader *)m_file.data();
+    bool valid = m_file.size() >= sizeof(SolvabilityDbHeader) &&
+                 memcmp(header->magic, DB_MAGIC, sizeof(DB_MAGIC)) == 0 && header->board < NUM_GEOMETRIES &&
+                 header->numHoles == (uint32_t)getGeometry((GeometryId)header->board).numHoles &&
+                 header->numHoles <= (uint32_t)MAX_DB_HOLES;
+    size_t words = valid ? ((size_t)1 << header->numHoles) / 64 + 1 : 0;
+    if (!valid || m_file.size() != sizeof(SolvabilityDbHeader) + words * sizeof(uint64_t)) {
+        printf("%s: not a solvability database\n", path);
+        m_file.close();
+        return false;
+    }
+    m_header = header;
+    m_bits = (const uint64_t *)(header + 1);
+    return true;
+}
+
+void SolvabilityDb::close() {
+    m_file.close();
+    m_header = NULL;
+    m_bits = NULL;
+}
+
+int SolvabilityDb::winningMoves(Bitboard pegs, Move *moves) const {
+    const Geometry &geo = getGeometry(board());
+    Move legal[MAX_JUMPS];
+    int n = getEngineOps(board()).generateMoves(pegs, legal);
+    int count = 0;
+    for (int i = 0; i < n; i++) {
+        if (winnable(pegs ^ moveJump(geo, legal[i]).mask))
+            moves[count++] = legal[i];
+    }
+    return count;
+}
+
+/* ################################################################# */
+// Building //
+
+template <GeometryId G>
+struct SolvabilityDbBuilder {
+    typedef StaticEngine<G> Engine;
+
+    // The top PART_BITS bits of a position pick its part. Parts own whole
+    // words of the table, so each word is only ever written by one thread.
+    static constexpr int PART_BITS = Engine::NUM_HOLES - 6 < 6 ? Engine::NUM_HOLES - 6 : 6;
+    static constexpr int LOW_BITS = Engine::NUM_HOLES - PART_BITS;
+
+    uint64_t *bits;
+
+    // Words are read while other threads write neighbouring words of the
+    // same layer, so every access is atomic
+    bool test(Bitboard pegs) const {
+        return (__atomic_load_n(&bits[pegs >> 6], __ATOMIC_RELAXED) >> (pegs & 63)) & 1;
+    }
+
+    void set(Bitboard pegs) {
+        uint64_t *word = &bits[pegs >> 6];
+        __atomic_store_n(word, __atomic_load_n(word, __ATOMIC_RELAXED) | bbBit(pegs & 63), __ATOMIC_RELAXED);
+    }
+
+    bool hasWinningMove(Bitboard pegs) const {
+        Move moves[MAX_JUMPS];
+        int n = Engine::generateMoves(pegs, moves);
+        for (int i = 0; i < n; i++) {
+            if (test(pegs ^ Engine::moveMask(moves[i])))
+                return true;
+        }
+        return false;
+    }
+
+    // Positions of one part with the given peg count, the low bits
+    // enumerated in increasing order (Gosper's hack)
+    uint64_t buildPart(int part, int pegs) {
+        int low = pegs - bbPopCount((Bitboard)part);
+        if (low < 0 || low > LOW_BITS)
+            return 0;
+        Bitboard high = (Bitboard)part << LOW_BITS;
+        Bitboard end = (Bitboard)1 << LOW_BITS;
+        uint64_t found = 0;
+        for (Bitboard s = low == 0 ? 0 : ((Bitboard)1 << low) - 1; s < end;) {
+            Bitboard p = high | s;
+            if (hasWinningMove(p)) {
+                set(p);
+                found++;
+            }
+            if (s == 0)
+                break;
+            Bitboard c = s & (~s + 1);
+            Bitboard r = s + c;
+            s = r | (((s ^ r) >> 2) >> bbLowest(c));
+        }
+        return found;
+    }
+
+    static uint64_t run(uint64_t *bits, int threads, SolvabilityDbProgress progress, void *user) {
+        SolvabilityDbBuilder builder = { bits };
+        uint64_t total = Engine::NUM_HOLES;
+        for (int h = 0; h < Engine::NUM_HOLES; h++)
+            builder.set(bbBit(h));
+        if (progress)
+            progress(1, Engine::NUM_HOLES, user);
+
+        for (int pegs = 2; pegs <= Engine::NUM_HOLES; pegs++) {
+            // Threads take the next part off a shared counter; the layer
+            // below is complete, so the order does not matter
+            std::atomic<int> next(0);
+            std::atomic<uint64_t> found(0);
+            runThreads(threads, [&](int) {
+                int part;
+                while ((part = next.fetch_add(1)) < (1 << PART_BITS))
+                    found += builder.buildPart(part, pegs);
+            });
+            total += found;
+            if (progress)
+                progress(pegs, found, user);
+        }
+        return total;
+    }
+};
+
+bool buildSolvabilityDb(GeometryId id, const char *path, int threads,
+                        SolvabilityDbProgress progress, void *user) {
+    const Geometry &geo = getGeometry(id);
+    if (geo.numHoles > MAX_DB_HOLES) {
+        printf("The %s board has %d holes, the database supports at most %d\n", geo.name, geo.numHoles,
+               MAX_DB_HOLES);
+        return false;
+    }
+    if (threads < 1)
+        threads = 1;
+
+    // One spare word keeps the table non-empty on tiny boards
+    std::vector<uint64_t> bits(((size_t)1 << geo.numHoles) / 64 + 1, 0);
+    SolvabilityDbHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, DB_MAGIC, sizeof(DB_MAGIC));
+    header.board = id;
+    header.numHoles = geo.numHoles;
+    header.winnable = dispatchGeometry<SolvabilityDbBuilder>(id, bits.data(), threads, progress, user);
+
+    FILE *f = fopen(path, "wb");
+    if (!f) {
+        printf("Cannot write %s\n", path);
+        return false;
+    }
+    bool written = fwrite(&header, sizeof(header), 1, f) == 1 &&
+                   fwrite(bits.data(), sizeof(uint64_t), bits.size(), f) == bits.size();
+    written = fclose(f) == 0 && written;
+    if (!written)
+        printf("Cannot write %s\n", path);
+    return written;
+}
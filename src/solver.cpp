@@ -0,0 +1,477 @@
+#include <stdio.h>
+#include <string.h>
+#include <algorithm>
+#include <chrono>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include "solver.h"
+#include "mapped_file.h"
+#include "pruning.h"
+#include "static_engine.h"
+#include "thread_utils.h"
+
+/* ################################################################# */
+// Dead-position table //
+
+DeadTable::DeadTable(int log2Slots) : m_slots((size_t)1 << log2Slots) {
+    m_mask = m_slots.size() - 1;
+    clear();
+}
+
+void DeadTable::clear() {
+    for (size_t i = 0; i < m_slots.size(); i++)
+        m_slots[i].store(0, std::memory_order_relaxed);
+}
+
+size_t DeadTable::size() const {
+    size_t count = 0;
+    for (size_t i = 0; i < m_slots.size(); i++)
+        count += m_slots[i].load(std::memory_order_relaxed) != 0;
+    return count;
+}
+
+bool DeadTable::contains(ZobristKey key, Bitboard pegs) const {
+    for (int p = 0; p < PROBES; p++) {
+        Bitboard slot = m_slots[(key + p) & m_mask].load(std::memory_order_relaxed);
+        if (slot == pegs)
+            return true;
+        if (slot == 0)
+            return false;
+    }
+    return false;
+}
+
+void DeadTable::insert(ZobristKey key, Bitboard pegs) {
+    for (int p = 0; p < PROBES; p++) {
+        std::atomic<Bitboard> &slot = m_slots[(key + p) & m_mask];
+        Bitboard current = slot.load(std::memory_order_relaxed);
+        if (current == pegs)
+            return;
+        if (current == 0) {
+            slot.store(pegs, std::memory_order_relaxed);
+            return;
+        }
+    }
+    // Window full: replace the home slot
+    m_slots[key & m_mask].store(pegs, std::memory_order_relaxed);
+}
+
+/* ################################################################# */
+// Saved tables //
+
+static const char DEAD_MAGIC[8] = "DEADTB1";
+
+// Order-independent sum over the slots, so a damaged file is not taken for
+// a table whose dead positions could hide a win
+static uint64_t tableChecksum(const Bitboard *slots, size_t count) {
+    uint64_t sum = 0;
+    for (size_t i = 0; i < count; i++)
+        sum += splitMix64(slots[i] ^ i);
+    return sum;
+}
+
+/* ################################################################# */
+// Search //
+
+// Stop flag and node count shared by the workers of a parallel search
+struct SearchControl {
+    static const uint64_t POLL_NODES = 4096;  // Nodes a worker expands between polls
+
+    std::atomic<bool> stop;
+    std::atomic<uint64_t> nodes;  // Published in steps of POLL_NODES
+    std::atomic<bool> limitReached;
+    uint64_t nodeLimit;
+
+    // Publish a step of nodes; true when the search should end
+    bool poll() {
+        uint64_t total = nodes.fetch_add(POLL_NODES, std::memory_order_relaxed) + POLL_NODES;
+        if (nodeLimit && total >= nodeLimit) {
+            limitReached.store(true);
+            stop.store(true);
+        }
+        return stop.load(std::memory_order_relaxed);
+    }
+};
+
+template <GeometryId G>
+struct ParallelSearch;
+
+template <GeometryId G>
+struct SolverSearch {
+    typedef StaticEngine<G> Engine;
+
+    DeadTable &dead;
+    SolverStats &stats;
+    Bitboard goal;          // Holes the last peg may end on
+    uint32_t symmetries;    // Symmetries that preserve the goal
+    bool anyHole;           // No target: symmetries holds all of them
+    PagodaCuts pagodas;
+    uint64_t nodeLimit;
+    bool aborted;
+    std::vector<Move> &line;  // Filled in reverse on the way back up
+    SearchControl *control;   // Parallel search only
+
+    // Symmetric positions are equally dead, so the table only holds canonical forms
+    Bitboard canonical(Bitboard pegs) const {
+        if (anyHole)
+            return Engine::canonical(pegs);
+        return Engine::canonical(pegs, symmetries);
+    }
+
+    bool search(Bitboard pegs, int pegCount) {
+        if (pegCount == 1)
+            return (pegs & goal) != 0;
+        if (pagodas.below(pegs)) {
+            stats.pagodaCuts++;
+            return false;
+        }
+        Bitboard canon = canonical(pegs);
+        ZobristKey key = splitMix64(canon);
+        if (dead.contains(key, canon)) {
+            stats.deadHits++;
+            return false;
+        }
+        if (nodeLimit && stats.nodes >= nodeLimit) {
+            aborted = true;
+            return false;
+        }
+        if (control && stats.nodes % SearchControl::POLL_NODES == SearchControl::POLL_NODES - 1 &&
+            control->poll()) {
+            aborted = true;
+            return false;
+        }
+        stats.nodes++;
+
+        Move moves[MAX_JUMPS];
+        int n = Engine::generateMoves(pegs, moves);
+        for (int i = 0; i < n; i++) {
+            const Jump &j = moveJump(Engine::geo, moves[i]);
+            if (search(pegs ^ j.mask, pegCount - 1)) {
+                line.push_back(moves[i]);
+                return true;
+            }
+            if (aborted)
+                return false;
+        }
+        dead.insert(key, canon);
+        return false;
+    }
+
+    static SolveResult run(DeadTable &dead, SolverStats &stats, Bitboard pegs, int targetHole,
+                           int pruning, int threads, uint64_t nodeLimit, std::vector<Move> &line) {
+        const Geometry &geo = Engine::geo;
+        pegs &= Engine::HOLES;
+        Bitboard goal = targetHole >= 0 ? bbBit(targetHole) : Engine::HOLES;
+        uint32_t symmetries = targetHole >= 0 ? symmetriesFixing(geo, targetHole) : allSymmetries(geo);
+        SolverSearch s = { dead, stats, goal, symmetries, targetHole < 0, {}, nodeLimit, false, line, NULL };
+
+        // The last peg can only stand on a hole of the start's class
+        if (pruning & PRUNE_CLASSES) {
+            s.goal = classGoal(geo, pegs, s.goal);
+            if (s.goal == 0)
+                return SOLVE_DEAD;
+        }
+        if (pruning & PRUNE_PAGODAS)
+            s.pagodas = goalPagodas(geo, s.goal);
+
+        if (pegs == 0)
+            return SOLVE_DEAD;
+        if (threads > 1)
+            return ParallelSearch<G>(s, threads).run(pegs);
+
+        bool won = s.search(pegs, bbPopCount(pegs));
+        std::reverse(line.begin(), line.end());
+        stats.threadNodes.assign(1, stats.nodes);
+        if (won)
+            return SOLVE_WIN;
+        return s.aborted ? SOLVE_UNKNOWN : SOLVE_DEAD;
+    }
+};
+
+/* ################################################################# */
+// Parallel search //
+
+template <GeometryId G>
+struct ParallelSearch {
+    typedef StaticEngine<G> Engine;
+
+    static const int MAX_SPLIT_PLIES = 8;
+    static const uint64_t TASKS_PER_THREAD = 64;
+
+    // A position in the split plies, shared between workers
+    struct Task {
+        Task *parent;
+        Move move;                 // Jump from the parent's position to this one
+        Bitboard pegs;
+        int pegCount;
+        std::atomic<int> pending;  // Children not yet known to fail
+
+        Task(Task *parent, Move move, Bitboard pegs, int pegCount)
+            : parent(parent), move(move), pegs(pegs), pegCount(pegCount), pending(0) {}
+    };
+
+    struct Worker {
+        std::mutex lock;
+        std::deque<Task *> queue;  // Own work at the back, stolen from the front
+        std::deque<Task> tasks;    // Tasks created by this worker; never move
+        SolverStats stats;
+        std::vector<Move> line;
+    };
+
+    SolverSearch<G> &shared;  // Goal, pruning and dead table of the search
+    SearchControl control;
+    std::vector<std::unique_ptr<Worker> > workers;
+    int splitPegs;            // Positions with more pegs are split into tasks
+    std::mutex winLock;
+    bool won;
+
+    ParallelSearch(SolverSearch<G> &search, int threads) : shared(search) {
+        control.stop = false;
+        control.nodes = 0;
+        control.limitReached = false;
+        control.nodeLimit = search.nodeLimit;
+        for (int t = 0; t < threads; t++)
+            workers.push_back(std::unique_ptr<Worker>(new Worker()));
+        splitPegs = 0;
+        won = false;
+    }
+
+    static uint64_t countLeaves(Bitboard pegs, int depth) {
+        if (depth == 0)
+            return 1;
+        Move moves[MAX_JUMPS];
+        int n = Engine::generateMoves(pegs, moves);
+        uint64_t leaves = 0;
+        for (int i = 0; i < n; i++)
+            leaves += countLeaves(pegs ^ Engine::moveMask(moves[i]), depth - 1);
+        return leaves;
+    }
+
+    // Split enough plies that every worker starts with many tasks, so that
+    // stealing only has to even out the differences in subtree size
+    int splitPlies(Bitboard pegs, int pegCount) const {
+        int plies = 0;
+        uint64_t width = 1;
+        while (width < TASKS_PER_THREAD * workers.size() && plies < MAX_SPLIT_PLIES && plies < pegCount - 2)
+            width = countLeaves(pegs, ++plies);
+        return plies;
+    }
+
+    Task *take(int id) {
+        Worker &own = *workers[id];
+        {
+            std::lock_guard<std::mutex> guard(own.lock);
+            if (!own.queue.empty()) {
+                Task *t = own.queue.back();
+                own.queue.pop_back();
+                return t;
+            }
+        }
+        for (size_t k = 1; k < workers.size(); k++) {
+            Worker &victim = *workers[(id + k) % workers.size()];
+            std::lock_guard<std::mutex> guard(victim.lock);
+            if (!victim.queue.empty()) {
+                Task *t = victim.queue.front();
+                victim.queue.pop_front();
+                return t;
+            }
+        }
+        return NULL;
+    }
+
+    // The subtree of a child of parent failed; a parent whose children have
+    // all failed is dead, and so on up. The search ends when the root fails.
+    void fail(SolverSearch<G> &s, Task *parent) {
+        for (Task *p = parent; p; p = p->parent) {
+            if (p->pending.fetch_sub(1) != 1)
+                return;
+            Bitboard canon = s.canonical(p->pegs);
+            s.dead.insert(splitMix64(canon), canon);
+        }
+        control.stop = true;
+    }
+
+    // rest: the moves after t's position, in order
+    void win(Task *t, const std::vector<Move> &rest) {
+        std::lock_guard<std::mutex> guard(winLock);
+        if (!won) {
+            won = true;
+            std::vector<Move> &line = shared.line;
+            line.clear();
+            for (Task *p = t; p->parent; p = p->parent)
+                line.push_back(p->move);
+            std::reverse(line.begin(), line.end());
+            line.insert(line.end(), rest.begin(), rest.end());
+        }
+        control.stop = true;
+    }
+
+    void expand(SolverSearch<G> &s, Worker &w, Task *t) {
+        if (t->pegCount == 1) {
+            if (t->pegs & s.goal)
+                win(t, std::vector<Move>());
+            else
+                fail(s, t->parent);
+            return;
+        }
+
+        // Below the split plies, the subtree is searched in one go
+        if (t->pegCount <= splitPegs) {
+            w.line.clear();
+            if (s.search(t->pegs, t->pegCount)) {
+                std::reverse(w.line.begin(), w.line.end());
+                win(t, w.line);
+            } else if (!s.aborted) {
+                fail(s, t->parent);
+            }
+            return;
+        }
+
+        if (s.pagodas.below(t->pegs)) {
+            w.stats.pagodaCuts++;
+            fail(s, t->parent);
+            return;
+        }
+        Bitboard canon = s.canonical(t->pegs);
+        ZobristKey key = splitMix64(canon);
+        if (s.dead.contains(key, canon)) {
+            w.stats.deadHits++;
+            fail(s, t->parent);
+            return;
+        }
+        w.stats.nodes++;
+
+        Move moves[MAX_JUMPS];
+        int n = Engine::generateMoves(t->pegs, moves);
+        if (n == 0) {
+            s.dead.insert(key, canon);
+            fail(s, t->parent);
+            return;
+        }
+        t->pending = n;
+        std::lock_guard<std::mutex> guard(w.lock);
+        for (int i = n - 1; i >= 0; i--) {
+            w.tasks.emplace_back(t, moves[i], t->pegs ^ Engine::moveMask(moves[i]), t->pegCount - 1);
+            w.queue.push_back(&w.tasks.back());
+        }
+    }
+
+    void work(int id) {
+        Worker &w = *workers[id];
+        SolverSearch<G> s = { shared.dead, w.stats, shared.goal, shared.symmetries, shared.anyHole,
+                              shared.pagodas, 0, false, w.line, &control };
+        while (!control.stop.load(std::memory_order_relaxed)) {
+            Task *t = take(id);
+            if (t)
+                expand(s, w, t);
+            else
+                std::this_thread::yield();
+        }
+    }
+
+    SolveResult run(Bitboard pegs) {
+        int pegCount = bbPopCount(pegs);
+        splitPegs = pegCount - splitPlies(pegs, pegCount);
+        workers[0]->tasks.emplace_back((Task *)NULL, Move(), pegs, pegCount);
+        workers[0]->queue.push_back(&workers[0]->tasks.back());
+
+        // The calling thread is worker 0
+        runThreads((int)workers.size(), [this](int t) { work(t); });
+
+        SolverStats &stats = shared.stats;
+        for (size_t t = 0; t < workers.size(); t++) {
+            const SolverStats &ws = workers[t]->stats;
+            stats.nodes += ws.nodes;
+            stats.deadHits += ws.deadHits;
+            stats.pagodaCuts += ws.pagodaCuts;
+            stats.threadNodes.push_back(ws.nodes);
+        }
+        if (won)
+            return SOLVE_WIN;
+        return control.limitReached ? SOLVE_UNKNOWN : SOLVE_DEAD;
+    }
+};
+
+Solver::Solver(int log2TableSlots) : m_dead(log2TableSlots) {
+    m_tableBoard = GEOMETRY_ENGLISH;
+    m_tableTarget = -1;
+    m_pruning = PRUNE_ALL;
+    m_threads = 1;
+    m_stats = SolverStats();
+}
+
+void Solver::clear() {
+    m_dead.clear();
+}
+
+SolveResult Solver::solve(GeometryId id, Bitboard pegs, std::vector<Move> &line,
+                          int targetHole, uint64_t nodeLimit) {
+    // Dead positions only hold for the board and goal they were found for
+    if (id != m_tableBoard || targetHole != m_tableTarget) {
+        m_dead.clear();
+        m_tableBoard = id;
+        m_tableTarget = targetHole;
+    }
+    line.clear();
+    m_stats = SolverStats();
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    SolveResult result = dispatchGeometry<SolverSearch>(id, m_dead, m_stats, pegs, targetHole,
+                                                        m_pruning, m_threads, nodeLimit, line);
+    m_stats.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return result;
+}
+
+bool Solver::saveTable(const char *path) const {
+    std::vector<Bitboard> slots(m_dead.capacity());
+    for (size_t i = 0; i < slots.size(); i++)
+        slots[i] = m_dead.slot(i);
+    DeadTableHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, DEAD_MAGIC, sizeof(DEAD_MAGIC));
+    header.board = m_tableBoard;
+    header.target = m_tableTarget;
+    while (((size_t)1 << header.log2Slots) < slots.size())
+        header.log2Slots++;
+    header.numHoles = getGeometry(m_tableBoard).numHoles;
+    header.entries = slots.size() - std::count(slots.begin(), slots.end(), (Bitboard)0);
+    header.checksum = tableChecksum(slots.data(), slots.size());
+
+    FILE *f = fopen(path, "wb");
+    if (!f) {
+        printf("Cannot write %s\n", path);
+        return false;
+    }
+    bool written = fwrite(&header, sizeof(header), 1, f) == 1 &&
+                   fwrite(slots.data(), sizeof(Bitboard), slots.size(), f) == slots.size();
+    written = fclose(f) == 0 && written;
+    if (!written)
+        printf("Cannot write %s\n", path);
+    return written;
+}
+
+bool Solver::loadTable(const char *path) {
+    MappedFile file;
+    if (!file.open(path))
+        return false;
+
+    const DeadTableHeader *header = (const DeadTableHeader *)file.data();
+    const Bitboard *slots = (const Bitboard *)(header + 1);
+    size_t count = m_dead.capacity();
+    bool valid = file.size() == sizeof(DeadTableHeader) + count * sizeof(Bitboard) &&
+                 memcmp(header->magic, DEAD_MAGIC, sizeof(DEAD_MAGIC)) == 0 && header->board < NUM_GEOMETRIES &&
+                 header->numHoles == (uint32_t)getGeometry((GeometryId)header->board).numHoles &&
+                 header->target >= -1 && header->target < (int32_t)header->numHoles &&
+                 header->log2Slots < 48 && ((size_t)1 << header->log2Slots) == count &&
+                 header->checksum == tableChecksum(slots, count);
+    if (!valid) {
+        printf("%s: not a dead-position table of this solver\n", path);
+        return false;
+    }
+    for (size_t i = 0; i < count; i++)
+        m_dead.setSlot(i, slots[i]);
+    m_tableBoard = (GeometryId)header->board;
+    m_tableTarget = header->target;
+    return true;
+}
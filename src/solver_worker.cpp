@@ -0,0 +1,260 @@
+#include <stdio.h>
+#include <algorithm>
+#include <chrono>
+#include "solver_worker.h"
+#include "fewest_pegs.h"
+#include "mcts.h"
+#include "move_solver.h"
+
+// Slice sizes, each about 10 to 20 ms: how long a cancelled job may run on
+static const uint64_t HINT_NODES_PER_SLICE = 100000;
+static const uint64_t MOVES_NODES_PER_SLICE = 50000;
+static const uint64_t FEWEST_NODES_PER_SLICE = 100000;
+static const double MCTS_SECONDS_PER_SLICE = 0.015;
+
+// Idle wait between looks at the job ring
+static const std::chrono::milliseconds IDLE_WAIT(2);
+
+// The solvers live on the worker thread and keep their tables between jobs
+struct SolverWorker::Solvers {
+    Solver hint;
+    MoveSolver moves;
+    FewestPegsSolver fewest;
+    MctsPlayer mcts;
+    bool hintCached;      // The hint table belongs to hintBoard's cache file
+    bool hintSearched;    // and has been searched since it was loaded
+    GeometryId hintBoard;
+
+    Solvers() : hintCached(false), hintSearched(false), hintBoard(GEOMETRY_ENGLISH) {}
+};
+
+struct SolverWorker::ActiveJob {
+    PostedJob posted;
+    bool active;
+    bool finished;           // result holds the final result, not delivered yet
+    bool started;
+    uint64_t nodes;          // Nodes searched for the job so far
+    int partial;             // Last partial value sent, -1 if none
+    SolverJobResult result;
+};
+
+SolverWorker::SolverWorker(const char *cacheDir)
+    : m_generation(0), m_quit(false), m_activeJobs(0), m_nodes(0), m_nodesPerSecond(0),
+      m_cacheDir(cacheDir ? cacheDir : "") {
+    m_thread = std::thread(&SolverWorker::run, this);
+}
+
+SolverWorker::~SolverWorker() {
+    m_quit = true;
+    m_thread.join();
+}
+
+bool SolverWorker::post(const SolverJob &job) {
+    PostedJob posted = { job, m_generation.load(std::memory_order_relaxed) };
+    return m_jobs.push(posted);
+}
+
+void SolverWorker::cancel() {
+    m_generation.fetch_add(1, std::memory_order_release);
+}
+
+bool SolverWorker::poll(SolverJobResult &result) {
+    while (m_results.pop(result)) {
+        if (result.generation == m_generation.load(std::memory_order_relaxed))
+            return true;
+    }
+    return false;
+}
+
+SolverProgress SolverWorker::progress() const {
+    SolverProgress p;
+    p.jobs = m_activeJobs.load(std::memory_order_relaxed);
+    p.nodes = m_nodes.load(std::memory_order_relaxed);
+    p.nodesPerSecond = m_nodesPerSecond.load(std::memory_order_relaxed);
+    return p;
+}
+
+static std::string hintTablePath(const std::string &dir, GeometryId board) {
+    return dir + "/" + getGeometry(board).name + ".cache";
+}
+
+// Save the hint table to its board's cache file if searches added to it
+void SolverWorker::saveHintTable(Solvers &solvers) {
+    if (!solvers.hintCached || !solvers.hintSearched)
+        return;
+    std::string path = hintTablePath(m_cacheDir, solvers.hintBoard);
+    if (solvers.hint.saveTable(path.c_str()))
+        printf("Saved solver cache %s\n", path.c_str());
+    solvers.hintSearched = false;
+}
+
+// Give the hint solver the cached table of board, saving the table of the
+// board it leaves
+void SolverWorker::switchHintTable(Solvers &solvers, GeometryId board) {
+    if (m_cacheDir.empty() || (solvers.hintCached && solvers.hintBoard == board))
+        return;
+    saveHintTable(solvers);
+    std::string path = hintTablePath(m_cacheDir, board);
+    if (solvers.hint.loadTable(path.c_str()))
+        printf("Loaded solver cache %s\n", path.c_str());
+    solvers.hintCached = true;
+    solvers.hintSearched = false;
+    solvers.hintBoard = board;
+}
+
+// Run one slice of a job; returns the nodes it searched. A finished job
+// sets finished and its result, a counter job may also send a partial one.
+uint64_t SolverWorker::runSlice(ActiveJob &active, Solvers &solvers) {
+    const SolverJob &job = active.posted.job;
+    SolverJobResult &r = active.result;
+    r.kind = job.kind;
+    r.generation = active.posted.generation;
+    r.final = true;
+    r.value = 0;
+    r.line.clear();
+    int partial = -1;
+    uint64_t nodes = 0;
+    bool first = !active.started;
+    active.started = true;
+
+    switch (job.kind) {
+    case JOB_HINT: {
+        if (first)
+            switchHintTable(solvers, job.board);
+        r.result = solvers.hint.solve(job.board, job.pegs, r.line, -1, HINT_NODES_PER_SLICE);
+        nodes = solvers.hint.stats().nodes;
+        solvers.hintSearched = solvers.hintSearched || nodes > 0;
+        break;
+    }
+    case JOB_MOVES_LEFT: {
+        r.result = solvers.moves.solve(job.board, job.pegs, r.line, -1, MOVES_NODES_PER_SLICE);
+        nodes = solvers.moves.stats().nodes;
+        if (r.result == SOLVE_WIN)
+            r.value = countChainMoves(getGeometry(job.board), r.line);
+        else if (r.result == SOLVE_UNKNOWN)
+            partial = solvers.moves.stats().bound;
+        break;
+    }
+    case JOB_FEWEST_PEGS: {
+        r.result = solvers.fewest.solve(job.board, job.pegs, r.value, r.line, FEWEST_NODES_PER_SLICE);
+        nodes = solvers.fewest.stats().nodes;
+        if (r.result == SOLVE_UNKNOWN)
+            partial = r.value;
+        break;
+    }
+    case JOB_MCTS: {
+        if (first)
+            solvers.mcts.setPosition(job.board, job.pegs);
+        const MctsStats &stats = solvers.mcts.stats();
+        uint64_t before = stats.playouts;
+        MctsOptions options = defaultMctsOptions();
+        options.threads = job.threads;
+        // A job out of time before its first playout searches on until a
+        // line is found
+        bool hasLine = !solvers.mcts.bestLine().empty();
+        options.seconds = hasLine ? std::min(MCTS_SECONDS_PER_SLICE, job.seconds - stats.seconds)
+                                  : MCTS_SECONDS_PER_SLICE;
+        solvers.mcts.search(options);
+        nodes = stats.playouts - before;
+        Move m;
+        bool hasMove = solvers.mcts.bestMove(m);
+        hasLine = !solvers.mcts.bestLine().empty();
+        r.result = SOLVE_UNKNOWN;
+        if (!hasMove) {
+            r.result = SOLVE_DEAD;
+        } else if (hasLine && (stats.seconds >= job.seconds || stats.bestPegs == 1)) {
+            r.result = SOLVE_WIN;
+            r.value = stats.bestPegs;
+            r.line = solvers.mcts.bestLine();
+        }
+        break;
+    }
+    default:
+        r.result = SOLVE_DEAD;
+        break;
+    }
+
+    if (r.result != SOLVE_UNKNOWN) {
+        active.finished = true;
+    } else if (partial >= 0 && partial != active.partial) {
+        // Partial values are only a courtesy: dropped if the ring is full
+        SolverJobResult update;
+        update.kind = job.kind;
+        update.generation = active.posted.generation;
+        update.final = false;
+        update.result = SOLVE_UNKNOWN;
+        update.value = partial;
+        if (m_results.push(update))
+            active.partial = partial;
+    }
+    return nodes;
+}
+
+void SolverWorker::run() {
+    Solvers *solvers = new Solvers;
+    ActiveJob active[NUM_SOLVER_JOBS];
+    for (int k = 0; k < NUM_SOLVER_JOBS; k++)
+        active[k].active = false;
+
+    // Speed over a window of at least a quarter second of searching
+    std::chrono::steady_clock::duration window(0);
+    uint64_t windowNodes = 0;
+
+    while (!m_quit.load(std::memory_order_relaxed)) {
+        PostedJob posted;
+        while (m_jobs.pop(posted)) {
+            ActiveJob &a = active[posted.job.kind];
+            a.posted = posted;
+            a.active = true;
+            a.finished = false;
+            a.started = false;
+            a.nodes = 0;
+            a.partial = -1;
+        }
+
+        uint64_t generation = m_generation.load(std::memory_order_acquire);
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        bool searched = false;
+        for (int k = 0; k < NUM_SOLVER_JOBS; k++) {
+            ActiveJob &a = active[k];
+            if (a.active && a.posted.generation != generation)
+                a.active = false;
+            if (!a.active)
+                continue;
+            if (!a.finished) {
+                uint64_t nodes = runSlice(a, *solvers);
+                a.nodes += nodes;
+                windowNodes += nodes;
+                searched = true;
+            }
+            // A final result waits for room in the ring
+            if (a.finished && m_results.push(a.result))
+                a.active = false;
+        }
+
+        unsigned jobs = 0;
+        uint64_t nodes = 0;
+        for (int k = 0; k < NUM_SOLVER_JOBS; k++) {
+            if (active[k].active) {
+                jobs |= 1u << k;
+                nodes += active[k].nodes;
+            }
+        }
+        m_activeJobs.store(jobs, std::memory_order_relaxed);
+        m_nodes.store(nodes, std::memory_order_relaxed);
+
+        if (searched) {
+            window += std::chrono::steady_clock::now() - start;
+            double seconds = std::chrono::duration<double>(window).count();
+            if (seconds >= 0.25) {
+                m_nodesPerSecond.store(windowNodes / seconds, std::memory_order_relaxed);
+                window = std::chrono::steady_clock::duration(0);
+                windowNodes = 0;
+            }
+        } else {
+            std::this_thread::sleep_for(IDLE_WAIT);
+        }
+    }
+    saveHintTable(*solvers);
+    delete solvers;
+}
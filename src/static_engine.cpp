@@ -0,0 +1,30 @@
+#include "static_engine.h"
+
+template <GeometryId G>
+struct MakeEngineOps {
+    static EngineOps run() {
+        EngineOps ops;
+        ops.id = G;
+        ops.hasAnyMove = &StaticEngine<G>::hasAnyMove;
+        ops.countMoves = &StaticEngine<G>::countMoves;
+        ops.generateMoves = &StaticEngine<G>::generateMoves;
+        ops.transform = static_cast<Bitboard (*)(Bitboard, int)>(&StaticEngine<G>::transform);
+        ops.canonical = static_cast<Bitboard (*)(Bitboard)>(&StaticEngine<G>::canonical);
+        ops.canonicalUnder = static_cast<Bitboard (*)(Bitboard, uint32_t)>(&StaticEngine<G>::canonical);
+        return ops;
+    }
+};
+
+struct EngineOpsTable {
+    EngineOps ops[NUM_GEOMETRIES];
+
+    EngineOpsTable() {
+        for (int i = 0; i < NUM_GEOMETRIES; i++)
+            ops[i] = dispatchGeometry<MakeEngineOps>((GeometryId)i);
+    }
+};
+
+const EngineOps &getEngineOps(GeometryId id) {
+    static EngineOpsTable table;  // Built on first use, thread-safe since C++11
+    return table.ops[id];
+}
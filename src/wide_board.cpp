@@ -0,0 +1,453 @@
+#include <string.h>
+#include "wide_board.h"
+#include "geometry.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#define WIDE_HAVE_X86 1
+#include <immintrin.h>
+#endif
+
+/* ################################################################# */
+// Row kernels //
+
+// Compute the per-direction jump sources of rows [rowBegin, rowEnd).
+// holes and pegs point at the padded board; out[d] receives row rowBegin's
+// words first, then the following rows, WIDE_ROW_WORDS words each.
+typedef void (*SourcesKernel)(const uint64_t *holes, const uint64_t *pegs,
+                              uint64_t *const out[WIDE_DIRECTIONS], int rowBegin, int rowEnd);
+
+static void sourcesScalar(const uint64_t *holes, const uint64_t *pegs,
+                          uint64_t *const out[WIDE_DIRECTIONS], int rowBegin, int rowEnd) {
+    const int W = WIDE_ROW_WORDS;
+    for (int r = rowBegin; r < rowEnd; r++) {
+        int base = (r + WIDE_GUARD_ROWS) * W;
+        int o = (r - rowBegin) * W;
+        for (int k = 0; k < W; k++) {
+            int i = base + k;
+            uint64_t p = pegs[i];
+            uint64_t e = holes[i] & ~p;
+
+            // Vertical jumps combine the same word of neighbouring rows
+            uint64_t up2 = holes[i - 2 * W] & ~pegs[i - 2 * W];
+            uint64_t down2 = holes[i + 2 * W] & ~pegs[i + 2 * W];
+            out[DIR_UP][o + k] = p & pegs[i - W] & up2;
+            out[DIR_DOWN][o + k] = p & pegs[i + W] & down2;
+
+            // Horizontal jumps shift the row, carrying bits across words
+            uint64_t pNext = k + 1 < W ? pegs[i + 1] : 0;
+            uint64_t eNext = k + 1 < W ? holes[i + 1] & ~pegs[i + 1] : 0;
+            uint64_t pPrev = k > 0 ? pegs[i - 1] : 0;
+            uint64_t ePrev = k > 0 ? holes[i - 1] & ~pegs[i - 1] : 0;
+            out[DIR_RIGHT][o + k] = p & ((p >> 1) | (pNext << 63)) & ((e >> 2) | (eNext << 62));
+            out[DIR_LEFT][o + k] = p & ((p << 1) | (pPrev >> 63)) & ((e << 2) | (ePrev >> 62));
+        }
+    }
+}
+
+#ifdef WIDE_HAVE_X86
+
+// Two 128-bit halves per row: lo = words 0-1, hi = words 2-3
+__attribute__((target("sse2")))
+static void sourcesSse2(const uint64_t *holes, const uint64_t *pegs,
+                        uint64_t *const out[WIDE_DIRECTIONS], int rowBegin, int rowEnd) {
+    const int W = WIDE_ROW_WORDS;
+    for (int r = rowBegin; r < rowEnd; r++) {
+        int base = (r + WIDE_GUARD_ROWS) * W;
+        int o = (r - rowBegin) * W;
+        for (int half = 0; half < 2; half++) {
+            int i = base + 2 * half;
+            __m128i p = _mm_loadu_si128((const __m128i *)(pegs + i));
+            __m128i up1 = _mm_loadu_si128((const __m128i *)(pegs + i - W));
+            __m128i down1 = _mm_loadu_si128((const __m128i *)(pegs + i + W));
+            __m128i up2 = _mm_andnot_si128(_mm_loadu_si128((const __m128i *)(pegs + i - 2 * W)),
+                                           _mm_loadu_si128((const __m128i *)(holes + i - 2 * W)));
+            __m128i down2 = _mm_andnot_si128(_mm_loadu_si128((const __m128i *)(pegs + i + 2 * W)),
+                                             _mm_loadu_si128((const __m128i *)(holes + i + 2 * W)));
+            _mm_storeu_si128((__m128i *)(out[DIR_UP] + o + 2 * half), _mm_and_si128(p, _mm_and_si128(up1, up2)));
+            _mm_storeu_si128((__m128i *)(out[DIR_DOWN] + o + 2 * half), _mm_and_si128(p, _mm_and_si128(down1, down2)));
+        }
+
+        __m128i pLo = _mm_loadu_si128((const __m128i *)(pegs + base));
+        __m128i pHi = _mm_loadu_si128((const __m128i *)(pegs + base + 2));
+        __m128i eLo = _mm_andnot_si128(pLo, _mm_loadu_si128((const __m128i *)(holes + base)));
+        __m128i eHi = _mm_andnot_si128(pHi, _mm_loadu_si128((const __m128i *)(holes + base + 2)));
+
+        // Word k's carry from word k + 1: lo gets [w1, w2], hi gets [w3, 0].
+        // Word k's carry from word k - 1: lo gets [0, w0], hi gets [w1, w2].
+        __m128i pMid = _mm_or_si128(_mm_srli_si128(pLo, 8), _mm_slli_si128(pHi, 8));
+        __m128i eMid = _mm_or_si128(_mm_srli_si128(eLo, 8), _mm_slli_si128(eHi, 8));
+        __m128i pLoNext = pMid, pHiNext = _mm_srli_si128(pHi, 8);
+        __m128i eLoNext = eMid, eHiNext = _mm_srli_si128(eHi, 8);
+        __m128i pLoPrev = _mm_slli_si128(pLo, 8), pHiPrev = pMid;
+        __m128i eLoPrev = _mm_slli_si128(eLo, 8), eHiPrev = eMid;
+
+        __m128i rightLo = _mm_and_si128(pLo, _mm_and_si128(
+            _mm_or_si128(_mm_srli_epi64(pLo, 1), _mm_slli_epi64(pLoNext, 63)),
+            _mm_or_si128(_mm_srli_epi64(eLo, 2), _mm_slli_epi64(eLoNext, 62))));
+        __m128i rightHi = _mm_and_si128(pHi, _mm_and_si128(
+            _mm_or_si128(_mm_srli_epi64(pHi, 1), _mm_slli_epi64(pHiNext, 63)),
+            _mm_or_si128(_mm_srli_epi64(eHi, 2), _mm_slli_epi64(eHiNext, 62))));
+        __m128i leftLo = _mm_and_si128(pLo, _mm_and_si128(
+            _mm_or_si128(_mm_slli_epi64(pLo, 1), _mm_srli_epi64(pLoPrev, 63)),
+            _mm_or_si128(_mm_slli_epi64(eLo, 2), _mm_srli_epi64(eLoPrev, 62))));
+        __m128i leftHi = _mm_and_si128(pHi, _mm_and_si128(
+            _mm_or_si128(_mm_slli_epi64(pHi, 1), _mm_srli_epi64(pHiPrev, 63)),
+            _mm_or_si128(_mm_slli_epi64(eHi, 2), _mm_srli_epi64(eHiPrev, 62))));
+        _mm_storeu_si128((__m128i *)(out[DIR_RIGHT] + o), rightLo);
+        _mm_storeu_si128((__m128i *)(out[DIR_RIGHT] + o + 2), rightHi);
+        _mm_storeu_si128((__m128i *)(out[DIR_LEFT] + o), leftLo);
+        _mm_storeu_si128((__m128i *)(out[DIR_LEFT] + o + 2), leftHi);
+    }
+}
+
+// One 256-bit register per row
+__attribute__((target("avx2")))
+static void sourcesAvx2(const uint64_t *holes, const uint64_t *pegs,
+                        uint64_t *const out[WIDE_DIRECTIONS], int rowBegin, int rowEnd) {
+    const int W = WIDE_ROW_WORDS;
+    const __m256i zero = _mm256_setzero_si256();
+    for (int r = rowBegin; r < rowEnd; r++) {
+        int i = (r + WIDE_GUARD_ROWS) * W;
+        int o = (r - rowBegin) * W;
+        __m256i p = _mm256_loadu_si256((const __m256i *)(pegs + i));
+        __m256i e = _mm256_andnot_si256(p, _mm256_loadu_si256((const __m256i *)(holes + i)));
+        __m256i up1 = _mm256_loadu_si256((const __m256i *)(pegs + i - W));
+        __m256i down1 = _mm256_loadu_si256((const __m256i *)(pegs + i + W));
+        __m256i up2 = _mm256_andnot_si256(_mm256_loadu_si256((const __m256i *)(pegs + i - 2 * W)),
+                                          _mm256_loadu_si256((const __m256i *)(holes + i - 2 * W)));
+        __m256i down2 = _mm256_andnot_si256(_mm256_loadu_si256((const __m256i *)(pegs + i + 2 * W)),
+                                            _mm256_loadu_si256((const __m256i *)(holes + i + 2 * W)));
+        _mm256_storeu_si256((__m256i *)(out[DIR_UP] + o), _mm256_and_si256(p, _mm256_and_si256(up1, up2)));
+        _mm256_storeu_si256((__m256i *)(out[DIR_DOWN] + o), _mm256_and_si256(p, _mm256_and_si256(down1, down2)));
+
+        // Next words [w1, w2, w3, 0] and previous words [0, w0, w1, w2]
+        __m256i pNext = _mm256_blend_epi32(_mm256_permute4x64_epi64(p, _MM_SHUFFLE(3, 3, 2, 1)), zero, 0xC0);
+        __m256i eNext = _mm256_blend_epi32(_mm256_permute4x64_epi64(e, _MM_SHUFFLE(3, 3, 2, 1)), zero, 0xC0);
+        __m256i pPrev = _mm256_blend_epi32(_mm256_permute4x64_epi64(p, _MM_SHUFFLE(2, 1, 0, 0)), zero, 0x03);
+        __m256i ePrev = _mm256_blend_epi32(_mm256_permute4x64_epi64(e, _MM_SHUFFLE(2, 1, 0, 0)), zero, 0x03);
+
+        __m256i right = _mm256_and_si256(p, _mm256_and_si256(
+            _mm256_or_si256(_mm256_srli_epi64(p, 1), _mm256_slli_epi64(pNext, 63)),
+            _mm256_or_si256(_mm256_srli_epi64(e, 2), _mm256_slli_epi64(eNext, 62))));
+        __m256i left = _mm256_and_si256(p, _mm256_and_si256(
+            _mm256_or_si256(_mm256_slli_epi64(p, 1), _mm256_srli_epi64(pPrev, 63)),
+            _mm256_or_si256(_mm256_slli_epi64(e, 2), _mm256_srli_epi64(ePrev, 62))));
+        _mm256_storeu_si256((__m256i *)(out[DIR_RIGHT] + o), right);
+        _mm256_storeu_si256((__m256i *)(out[DIR_LEFT] + o), left);
+    }
+}
+
+#endif /* WIDE_HAVE_X86 */
+
+static bool kernelSupported(WideKernel kernel) {
+#ifdef WIDE_HAVE_X86
+    if (kernel == WIDE_KERNEL_AVX2)
+        return __builtin_cpu_supports("avx2");
+    if (kernel == WIDE_KERNEL_SSE2)
+        return __builtin_cpu_supports("sse2");
+#endif
+    return kernel == WIDE_KERNEL_SCALAR;
+}
+
+static SourcesKernel kernelFunction(WideKernel kernel) {
+#ifdef WIDE_HAVE_X86
+    if (kernel == WIDE_KERNEL_AVX2)
+        return sourcesAvx2;
+    if (kernel == WIDE_KERNEL_SSE2)
+        return sourcesSse2;
+#endif
+    return sourcesScalar;
+}
+
+WideKernel wideBestKernel() {
+    if (kernelSupported(WIDE_KERNEL_AVX2))
+        return WIDE_KERNEL_AVX2;
+    if (kernelSupported(WIDE_KERNEL_SSE2))
+        return WIDE_KERNEL_SSE2;
+    return WIDE_KERNEL_SCALAR;
+}
+
+static WideKernel activeKernel = wideBestKernel();
+static SourcesKernel activeSources = kernelFunction(activeKernel);
+
+bool wideSelectKernel(WideKernel kernel) {
+    if (!kernelSupported(kernel))
+        return false;
+    activeKernel = kernel;
+    activeSources = kernelFunction(kernel);
+    return true;
+}
+
+WideKernel wideActiveKernel() {
+    return activeKernel;
+}
+
+const char *wideKernelName(WideKernel kernel) {
+    switch (kernel) {
+    case WIDE_KERNEL_AVX2: return "avx2";
+    case WIDE_KERNEL_SSE2: return "sse2";
+    default:               return "scalar";
+    }
+}
+
+/* ################################################################# */
+// Board //
+
+// Rows handled per kernel call when scanning into a stack buffer
+const int WIDE_CHUNK_ROWS = 16;
+
+struct SourcesChunk {
+    uint64_t words[WIDE_DIRECTIONS][WIDE_CHUNK_ROWS * WIDE_ROW_WORDS];
+    uint64_t *out[WIDE_DIRECTIONS];
+
+    SourcesChunk() {
+        for (int d = 0; d < WIDE_DIRECTIONS; d++)
+            out[d] = words[d];
+    }
+};
+
+WideBoard::WideBoard() {
+    reset(0, 0);
+}
+
+WideBoard::WideBoard(int width, int height) {
+    reset(width, height);
+    for (int r = 0; r < m_height; r++) {
+        for (int c = 0; c < m_width; c++)
+            setHole(r, c, true);
+    }
+}
+
+void WideBoard::reset(int width, int height) {
+    m_width = width < 0 ? 0 : (width > WIDE_MAX_SIZE ? WIDE_MAX_SIZE : width);
+    m_height = height < 0 ? 0 : (height > WIDE_MAX_SIZE ? WIDE_MAX_SIZE : height);
+    m_holeCount = 0;
+    m_pegCount = 0;
+    m_hash.lo = 0;
+    m_hash.hi = 0;
+    size_t words = (size_t)(m_height + 2 * WIDE_GUARD_ROWS) * WIDE_ROW_WORDS;
+    m_holes.assign(words, 0);
+    m_pegs.assign(words, 0);
+}
+
+bool WideBoard::parse(const std::vector<std::string> &lines) {
+    int height = (int)lines.size();
+    int width = 0;
+    for (int r = 0; r < height; r++)
+        width = (int)lines[r].size() > width ? (int)lines[r].size() : width;
+    if (height == 0 || width == 0 || height > WIDE_MAX_SIZE || width > WIDE_MAX_SIZE)
+        return false;
+    reset(width, height);
+    for (int r = 0; r < height; r++) {
+        for (int c = 0; c < (int)lines[r].size(); c++) {
+            char ch = lines[r][c];
+            if (ch == 'o' || ch == '_')
+                setHole(r, c, true);
+            if (ch == 'o')
+                setPeg(r, c, true);
+        }
+    }
+    return true;
+}
+
+WideBoard WideBoard::cross(int size, int armWidth) {
+    WideBoard board(0, 0);
+    board.reset(size, size);
+    int armStart = (board.m_width - armWidth) / 2;
+    for (int r = 0; r < board.m_height; r++) {
+        for (int c = 0; c < board.m_width; c++) {
+            bool inRowArm = r >= armStart && r < armStart + armWidth;
+            bool inColArm = c >= armStart && c < armStart + armWidth;
+            if (inRowArm || inColArm)
+                board.setHole(r, c, true);
+        }
+    }
+    board.fillAllBut(board.m_height / 2, board.m_width / 2);
+    return board;
+}
+
+void WideBoard::setHole(int row, int col, bool hole) {
+    if (isHole(row, col) == hole)
+        return;
+    if (!hole)
+        setPeg(row, col, false);
+    m_holes[wordIndex(row, col)] ^= (uint64_t)1 << (col & 63);
+    m_holeCount += hole ? 1 : -1;
+}
+
+void WideBoard::setPeg(int row, int col, bool peg) {
+    if (!isHole(row, col) || hasPeg(row, col) == peg)
+        return;
+    toggle(row, col);
+    m_pegCount += peg ? 1 : -1;
+}
+
+void WideBoard::fillAllBut(int row, int col) {
+    m_pegs = m_holes;
+    m_pegCount = m_holeCount;
+    m_hash.lo = 0;
+    m_hash.hi = 0;
+    for (int r = 0; r < m_height; r++) {
+        for (int c = 0; c < m_width; c++) {
+            if (hasPeg(r, c))
+                m_hash ^= zobristCell128(r, c);
+        }
+    }
+    setPeg(row, col, false);
+}
+
+void WideBoard::allocSources(WideSources &out) const {
+    for (int d = 0; d < WIDE_DIRECTIONS; d++)
+        out.dir[d].assign(m_pegs.size(), 0);
+}
+
+void WideBoard::computeSources(WideSources &out, int rowBegin, int rowEnd) const {
+    if (rowBegin < 0)
+        rowBegin = 0;
+    if (rowEnd > m_height)
+        rowEnd = m_height;
+    if (rowBegin >= rowEnd)
+        return;
+    uint64_t *dst[WIDE_DIRECTIONS];
+    for (int d = 0; d < WIDE_DIRECTIONS; d++)
+        dst[d] = &out.dir[d][(rowBegin + WIDE_GUARD_ROWS) * WIDE_ROW_WORDS];
+    activeSources(&m_holes[0], &m_pegs[0], dst, rowBegin, rowEnd);
+}
+
+bool WideBoard::hasAnyMove() const {
+    SourcesChunk chunk;
+    for (int r = 0; r < m_height; r += WIDE_CHUNK_ROWS) {
+        int end = r + WIDE_CHUNK_ROWS < m_height ? r + WIDE_CHUNK_ROWS : m_height;
+        activeSources(&m_holes[0], &m_pegs[0], chunk.out, r, end);
+        uint64_t any = 0;
+        for (int d = 0; d < WIDE_DIRECTIONS; d++) {
+            for (int k = 0; k < (end - r) * WIDE_ROW_WORDS; k++)
+                any |= chunk.words[d][k];
+        }
+        if (any)
+            return true;
+    }
+    return false;
+}
+
+int WideBoard::countMoves() const {
+    SourcesChunk chunk;
+    int count = 0;
+    for (int r = 0; r < m_height; r += WIDE_CHUNK_ROWS) {
+        int end = r + WIDE_CHUNK_ROWS < m_height ? r + WIDE_CHUNK_ROWS : m_height;
+        activeSources(&m_holes[0], &m_pegs[0], chunk.out, r, end);
+        for (int d = 0; d < WIDE_DIRECTIONS; d++) {
+            for (int k = 0; k < (end - r) * WIDE_ROW_WORDS; k++)
+                count += __builtin_popcountll(chunk.words[d][k]);
+        }
+    }
+    return count;
+}
+
+void WideBoard::generateMoves(std::vector<WideMove> &moves) const {
+    moves.clear();
+    SourcesChunk chunk;
+    for (int r = 0; r < m_height; r += WIDE_CHUNK_ROWS) {
+        int end = r + WIDE_CHUNK_ROWS < m_height ? r + WIDE_CHUNK_ROWS : m_height;
+        activeSources(&m_holes[0], &m_pegs[0], chunk.out, r, end);
+        for (int d = 0; d < WIDE_DIRECTIONS; d++) {
+            for (int k = 0; k < (end - r) * WIDE_ROW_WORDS; k++) {
+                uint64_t bits = chunk.words[d][k];
+                while (bits) {
+                    WideMove m;
+                    m.row = (uint8_t)(r + k / WIDE_ROW_WORDS);
+                    m.col = (uint8_t)((k % WIDE_ROW_WORDS) * 64 + __builtin_ctzll(bits));
+                    m.dir = (uint8_t)d;
+                    moves.push_back(m);
+                    bits &= bits - 1;
+                }
+            }
+        }
+    }
+}
+
+int WideBoard::targetRow(WideMove m) {
+    return m.row + 2 * DIR_ROW_STEP[m.dir];
+}
+
+int WideBoard::targetCol(WideMove m) {
+    return m.col + 2 * DIR_COL_STEP[m.dir];
+}
+
+bool WideBoard::isLegal(WideMove m) const {
+    if (m.dir >= WIDE_DIRECTIONS || m.row >= m_height || m.col >= m_width)
+        return false;
+    int overRow = m.row + DIR_ROW_STEP[m.dir], overCol = m.col + DIR_COL_STEP[m.dir];
+    int toRow = targetRow(m), toCol = targetCol(m);
+    if (toRow < 0 || toRow >= m_height || toCol < 0 || toCol >= m_width)
+        return false;
+    return hasPeg(m.row, m.col) && hasPeg(overRow, overCol) &&
+           isHole(toRow, toCol) && !hasPeg(toRow, toCol);
+}
+
+void WideBoard::applyMove(WideMove m) {
+    toggle(m.row, m.col);
+    toggle(m.row + DIR_ROW_STEP[m.dir], m.col + DIR_COL_STEP[m.dir]);
+    toggle(targetRow(m), targetCol(m));
+    m_pegCount--;
+}
+
+void WideBoard::revertMove(WideMove m) {
+    toggle(m.row, m.col);
+    toggle(m.row + DIR_ROW_STEP[m.dir], m.col + DIR_COL_STEP[m.dir]);
+    toggle(targetRow(m), targetCol(m));
+    m_pegCount++;
+}
+
+std::string WideBoard::toString() const {
+    std::string out;
+    for (int r = 0; r < m_height; r++) {
+        for (int c = 0; c < m_width; c++)
+            out += isHole(r, c) ? (hasPeg(r, c) ? 'o' : '_') : '.';
+        out += '\n';
+    }
+    return out;
+}
+
+/* ################################################################# */
+// Incremental move set //
+
+int WideMoveSet::rowCount(int row) const {
+    int count = 0;
+    int base = (row + WIDE_GUARD_ROWS) * WIDE_ROW_WORDS;
+    for (int d = 0; d < WIDE_DIRECTIONS; d++) {
+        for (int k = 0; k < WIDE_ROW_WORDS; k++)
+            count += __builtin_popcountll(m_sources.dir[d][base + k]);
+    }
+    return count;
+}
+
+void WideMoveSet::init(const WideBoard &board) {
+    board.allocSources(m_sources);
+    board.computeSources(m_sources, 0, board.height());
+    m_count = 0;
+    for (int r = 0; r < board.height(); r++)
+        m_count += rowCount(r);
+}
+
+void WideMoveSet::update(const WideBoard &board, WideMove m) {
+    int toRow = WideBoard::targetRow(m);
+    int first = (m.row < toRow ? m.row : toRow) - 2;
+    int last = (m.row > toRow ? m.row : toRow) + 2;
+    if (first < 0)
+        first = 0;
+    if (last >= board.height())
+        last = board.height() - 1;
+    for (int r = first; r <= last; r++)
+        m_count -= rowCount(r);
+    board.computeSources(m_sources, first, last + 1);
+    for (int r = first; r <= last; r++)
+        m_count += rowCount(r);
+}
+
+bool WideMoveSet::contains(WideMove m) const {
+    if (m.dir >= WIDE_DIRECTIONS)
+        return false;
+    int i = (m.row + WIDE_GUARD_ROWS) * WIDE_ROW_WORDS + (m.col >> 6);
+    return (m_sources.dir[m.dir][i] >> (m.col & 63)) & 1;
+}
@@ -0,0 +1,151 @@
+/*
+    Beam search on a wide board (see beam_search.h).
+
+    The board is a scaled-up English cross unless --layout reads one from
+    a file in the format of WideBoard::parse. The search reports the fewest
+    pegs it reached and replays its line to check it.
+
+    Usage: beam [--size N] [--arm N] [--layout FILE] [--width N] [--threads N]
+                [--seconds S] [--memory MB] [--eval NAME] [--compare]
+
+      --size N, --arm N  cross of N x N holes with arms N holes wide
+                         (default 33 and a third of the size)
+      --width N          positions kept per layer (default 1000)
+      --seconds S        stop after S seconds
+      --memory MB        narrow the beam and stop to stay within MB megabytes
+      --eval NAME        pagoda (default), isolated or corners
+      --compare          search once with each evaluation and tabulate
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fstream>
+#include <thread>
+#include "beam_search.h"
+
+struct NamedEvaluation {
+    const char *name;
+    WideEvaluation evaluate;
+};
+
+static const NamedEvaluation EVALUATIONS[] = {
+    { "pagoda", widePagodaScore },
+    { "isolated", wideIsolatedScore },
+    { "corners", wideCornerScore },
+};
+static const int NUM_EVALUATIONS = sizeof(EVALUATIONS) / sizeof(EVALUATIONS[0]);
+
+static void usage() {
+    fprintf(stderr, "Usage: beam [--size N] [--arm N] [--layout FILE] [--width N] [--threads N]\n"
+                    "            [--seconds S] [--memory MB] [--eval NAME] [--compare]\n");
+}
+
+static void printLayer(int layer, int pegs, size_t positions, double bestScore, void *) {
+    if (layer % 25 == 0) {
+        printf("layer %4d %6d pegs %8zu positions, best score %.3f\n", layer, pegs, positions, bestScore);
+        fflush(stdout);
+    }
+}
+
+// Replay a line on the start; true if every jump is legal and it ends with pegs pegs
+static bool replay(WideBoard board, const std::vector<WideMove> &line, int pegs) {
+    for (size_t i = 0; i < line.size(); i++) {
+        if (!board.isLegal(line[i]))
+            return false;
+        board.applyMove(line[i]);
+    }
+    return board.pegCount() == pegs;
+}
+
+static bool readLayout(const char *path, WideBoard &board) {
+    std::ifstream in(path);
+    std::vector<std::string> lines;
+    std::string line;
+    while (std::getline(in, line))
+        lines.push_back(line);
+    return board.parse(lines);
+}
+
+int main(int argc, char *argv[]) {
+    int size = 33, arm = -1;
+    const char *layout = NULL;
+    const char *evalName = "pagoda";
+    bool comparing = false;
+    BeamOptions options = defaultBeamOptions();
+    options.threads = (int)std::thread::hardware_concurrency();
+
+    for (int i = 1; i < argc; i++) {
+        bool hasValue = i + 1 < argc;
+        if (strcmp(argv[i], "--size") == 0 && hasValue) {
+            size = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--arm") == 0 && hasValue) {
+            arm = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--layout") == 0 && hasValue) {
+            layout = argv[++i];
+        } else if (strcmp(argv[i], "--width") == 0 && hasValue) {
+            options.width = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--threads") == 0 && hasValue) {
+            options.threads = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--seconds") == 0 && hasValue) {
+            options.seconds = atof(argv[++i]);
+        } else if (strcmp(argv[i], "--memory") == 0 && hasValue) {
+            options.memoryBytes = (size_t)atol(argv[++i]) << 20;
+        } else if (strcmp(argv[i], "--eval") == 0 && hasValue) {
+            evalName = argv[++i];
+        } else if (strcmp(argv[i], "--compare") == 0) {
+            comparing = true;
+        } else {
+            usage();
+            return 2;
+        }
+    }
+
+    options.evaluate = NULL;
+    for (int e = 0; e < NUM_EVALUATIONS; e++) {
+        if (strcmp(evalName, EVALUATIONS[e].name) == 0)
+            options.evaluate = EVALUATIONS[e].evaluate;
+    }
+    if (!options.evaluate) {
+        fprintf(stderr, "Unknown evaluation '%s'\n", evalName);
+        return 2;
+    }
+
+    WideBoard board;
+    if (layout) {
+        if (!readLayout(layout, board)) {
+            fprintf(stderr, "Cannot read a board from %s\n", layout);
+            return 2;
+        }
+    } else {
+        if (size < 3 || size > WIDE_MAX_SIZE) {
+            fprintf(stderr, "Size must be between 3 and %d\n", WIDE_MAX_SIZE);
+            return 2;
+        }
+        board = WideBoard::cross(size, arm > 0 ? arm : size / 3);
+    }
+    printf("%dx%d board, %d holes, %d pegs, beam width %d, %d threads\n", board.width(), board.height(),
+           board.holeCount(), board.pegCount(), options.width, options.threads < 1 ? 1 : options.threads);
+
+    if (comparing) {
+        printf("%-10s %8s %8s %14s %10s\n", "eval", "pegs", "jumps", "positions", "seconds");
+        for (int e = 0; e < NUM_EVALUATIONS; e++) {
+            options.evaluate = EVALUATIONS[e].evaluate;
+            BeamResult result = wideBeamSearch(board, options);
+            printf("%-10s %8d %8d %14llu %10.2f%s\n", EVALUATIONS[e].name, result.bestPegs, result.layers,
+                   (unsigned long long)result.positions, result.seconds, result.exhausted ? "" : "  (budget)");
+        }
+        return 0;
+    }
+
+    options.progress = printLayer;
+    BeamResult result = wideBeamSearch(board, options);
+    printf("\nBest: %d pegs after %d jumps%s, %llu positions scored, %.2f s\n", result.bestPegs, result.layers,
+           result.exhausted ? "" : " (stopped by the budget)", (unsigned long long)result.positions,
+           result.seconds);
+    if (!replay(board, result.line, result.bestPegs)) {
+        printf("The line does not replay\n");
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,105 @@
+/*
+    Build the solvability database of a board (see solvability_db.h).
+
+    The file is written to BOARD.sdb unless --output says otherwise; the
+    game maps BOARD.sdb from its working directory at startup. With
+    --check, the written file is mapped again and compared with the
+    solver on positions from random games.
+
+    Usage: build_db [--board NAME] [--output PATH] [--threads N] [--check N]
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <chrono>
+#include <string>
+#include <thread>
+#include "solvability_db.h"
+#include "solver.h"
+#include "static_engine.h"
+
+static void usage() {
+    fprintf(stderr, "Usage: build_db [--board NAME] [--output PATH] [--threads N] [--check N]\n");
+}
+
+static void printLayer(int pegs, uint64_t winnable, void *) {
+    printf("%5d pegs %14llu winnable\n", pegs, (unsigned long long)winnable);
+    fflush(stdout);
+}
+
+// Compare the database with the solver along random games; returns the
+// number of disagreements
+static int check(const SolvabilityDb &db, int games) {
+    GeometryId id = db.board();
+    const Geometry &geo = getGeometry(id);
+    const EngineOps &engine = getEngineOps(id);
+    Solver solver;
+    uint64_t rng = 88172645463325252ULL;
+    int positions = 0, mismatches = 0;
+    for (int g = 0; g < games; g++) {
+        Bitboard pegs = initialBoard(geo, g % geo.numHoles).pegs;
+        Move moves[MAX_JUMPS];
+        int n;
+        while ((n = engine.generateMoves(pegs, moves)) > 0) {
+            std::vector<Move> line;
+            bool solvable = solver.solve(id, pegs, line) == SOLVE_WIN;
+            Move winning[MAX_JUMPS];
+            bool consistent = db.winningMoves(pegs, winning) > 0 || bbPopCount(pegs) == 1;
+            if (db.winnable(pegs) != solvable || (solvable && !consistent))
+                mismatches++;
+            positions++;
+            rng ^= rng << 13;
+            rng ^= rng >> 7;
+            rng ^= rng << 17;
+            pegs ^= moveJump(geo, moves[rng % n]).mask;
+        }
+    }
+    printf("Checked %d positions against the solver: %d mismatches\n", positions, mismatches);
+    return mismatches;
+}
+
+int main(int argc, char *argv[]) {
+    GeometryId board = GEOMETRY_ENGLISH;
+    const char *output = NULL;
+    int threads = (int)std::thread::hardware_concurrency();
+    int checkGames = 0;
+
+    for (int i = 1; i < argc; i++) {
+        bool hasValue = i + 1 < argc;
+        if (strcmp(argv[i], "--board") == 0 && hasValue) {
+            if (!findGeometry(argv[++i], board)) {
+                fprintf(stderr, "Unknown board '%s'\n", argv[i]);
+                return 2;
+            }
+        } else if (strcmp(argv[i], "--output") == 0 && hasValue) {
+            output = argv[++i];
+        } else if (strcmp(argv[i], "--threads") == 0 && hasValue) {
+            threads = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--check") == 0 && hasValue) {
+            checkGames = atoi(argv[++i]);
+        } else {
+            usage();
+            return 2;
+        }
+    }
+
+    const Geometry &geo = getGeometry(board);
+    std::string path = output ? output : std::string(geo.name) + ".sdb";
+    printf("Building the %s database (%d holes, %llu positions) on %d threads\n", geo.name, geo.numHoles,
+           1ULL << geo.numHoles, threads < 1 ? 1 : threads);
+
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    if (!buildSolvabilityDb(board, path.c_str(), threads, printLayer, NULL))
+        return 1;
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    SolvabilityDb db;
+    if (!db.open(path.c_str()))
+        return 1;
+    printf("Wrote %s: %llu winnable positions, %.1f s\n", path.c_str(), (unsigned long long)db.winnableCount(),
+           seconds);
+    if (checkGames > 0 && check(db, checkGames) != 0)
+        return 1;
+    return 0;
+}
@@ -0,0 +1,170 @@
+/*
+    Build the position index of a start (see position_index.h).
+
+    The file is written to BOARD.idx unless --output says otherwise; the
+    game maps BOARD.idx from its working directory for the board's default
+    start. After the build the file is mapped again and every position is
+    looked up once to time the queries. With --check, positions from random
+    games are also compared with the solver, and positions from another
+    start must be reported missing unless they are reachable from this one
+    (or share a record's fingerprint, one position in 65536).
+
+    Usage: build_index [--board NAME] [--empty HOLE] [--output PATH] [--check N]
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <chrono>
+#include <string>
+#include "position_index.h"
+#include "solver.h"
+#include "static_engine.h"
+
+static void usage() {
+    fprintf(stderr, "Usage: build_index [--board NAME] [--empty HOLE] [--output PATH] [--check N]\n");
+}
+
+static void printStage(const char *stage, int layer, uint64_t positions, void *) {
+    if (layer < 0)
+        printf("%-8s %14llu positions\n", stage, (unsigned long long)positions);
+    else
+        printf("%-8s layer %2d %14llu positions\n", stage, layer, (unsigned long long)positions);
+    fflush(stdout);
+}
+
+// Time a lookup of every position of random games; returns the number of
+// reachable positions that were not found
+static int timeLookups(const PositionIndex &index, int games) {
+    const Geometry &geo = getGeometry(index.board());
+    const EngineOps &engine = getEngineOps(index.board());
+    std::vector<Bitboard> positions;
+    uint64_t rng = 88172645463325252ULL;
+    for (int g = 0; g < games; g++) {
+        Bitboard pegs = initialBoard(geo, index.startHole()).pegs;
+        Move moves[MAX_JUMPS];
+        int n;
+        do {
+            positions.push_back(pegs);
+            n = engine.generateMoves(pegs, moves);
+            rng ^= rng << 13;
+            rng ^= rng >> 7;
+            rng ^= rng << 17;
+            if (n > 0)
+                pegs ^= moveJump(geo, moves[rng % n]).mask;
+        } while (n > 0);
+    }
+
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    int missing = 0;
+    uint64_t solutions = 0;
+    for (size_t i = 0; i < positions.size(); i++) {
+        PositionInfo info;
+        if (index.lookup(positions[i], info))
+            solutions += info.solutions;
+        else
+            missing++;
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    printf("Looked up %d positions in %.3f s (%.0f ns each, checksum %llu), %d missing\n", (int)positions.size(),
+           seconds, seconds * 1e9 / positions.size(), (unsigned long long)solutions, missing);
+    return missing;
+}
+
+// Compare the index with the solver along random games; returns the number
+// of disagreements
+static int check(const PositionIndex &index, int games) {
+    GeometryId id = index.board();
+    const Geometry &geo = getGeometry(id);
+    const EngineOps &engine = getEngineOps(id);
+    Solver anywhere, onGoal;
+    uint64_t rng = 2463534242ULL;
+    int positions = 0, foreign = 0, mismatches = 0;
+    for (int g = 0; g < games; g++) {
+        // Every other game starts elsewhere, so some of its positions are
+        // not in the index
+        bool own = g % 2 == 0;
+        Bitboard pegs = initialBoard(geo, own ? index.startHole() : g % geo.numHoles).pegs;
+        Move moves[MAX_JUMPS];
+        int n;
+        do {
+            std::vector<Move> line;
+            PositionInfo info;
+            bool found = index.lookup(pegs, info);
+            if (own && !found) {
+                mismatches++;
+            } else if (found) {
+                bool solvable = anywhere.solve(id, pegs, line) == SOLVE_WIN;
+                bool solvableOnGoal = onGoal.solve(id, pegs, line, index.startHole()) == SOLVE_WIN;
+                if ((info.fewestPegs == 1) != solvable || (info.solutions > 0) != solvableOnGoal ||
+                    info.fewestPegs > bbPopCount(pegs))
+                    mismatches++;
+            } else {
+                foreign++;
+            }
+            positions++;
+            n = engine.generateMoves(pegs, moves);
+            rng ^= rng << 13;
+            rng ^= rng >> 7;
+            rng ^= rng << 17;
+            if (n > 0)
+                pegs ^= moveJump(geo, moves[rng % n]).mask;
+        } while (n > 0);
+    }
+    printf("Checked %d positions against the solver (%d not in the index): %d mismatches\n", positions, foreign,
+           mismatches);
+    return mismatches;
+}
+
+int main(int argc, char *argv[]) {
+    GeometryId board = GEOMETRY_ENGLISH;
+    int emptyHole = -1;
+    const char *output = NULL;
+    int checkGames = 0;
+
+    for (int i = 1; i < argc; i++) {
+        bool hasValue = i + 1 < argc;
+        if (strcmp(argv[i], "--board") == 0 && hasValue) {
+            if (!findGeometry(argv[++i], board)) {
+                fprintf(stderr, "Unknown board '%s'\n", argv[i]);
+                return 2;
+            }
+        } else if (strcmp(argv[i], "--empty") == 0 && hasValue) {
+            emptyHole = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--output") == 0 && hasValue) {
+            output = argv[++i];
+        } else if (strcmp(argv[i], "--check") == 0 && hasValue) {
+            checkGames = atoi(argv[++i]);
+        } else {
+            usage();
+            return 2;
+        }
+    }
+
+    const Geometry &geo = getGeometry(board);
+    if (emptyHole < 0 || emptyHole >= geo.numHoles)
+        emptyHole = geo.defaultEmpty;
+    std::string path = output ? output : std::string(geo.name) + ".idx";
+    printf("Building the %s index from hole %d\n", geo.name, emptyHole);
+
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    if (!buildPositionIndex(board, emptyHole, path.c_str(), printStage, NULL))
+        return 1;
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    PositionIndex index;
+    if (!index.open(path.c_str()))
+        return 1;
+    PositionInfo info;
+    index.lookup(initialBoard(geo, emptyHole).pegs, info);
+    printf("Wrote %s: %llu positions, %.2f bytes each, %.1f s\n", path.c_str(), (unsigned long long)index.size(),
+           (double)index.fileSize() / index.size(), seconds);
+    printf("Start: fewest pegs %d, %llu%s lines to a single peg on hole %d\n", info.fewestPegs,
+           (unsigned long long)info.solutions, info.solutions == UINT64_MAX ? " or more" : "", emptyHole);
+
+    if (timeLookups(index, 1000) != 0)
+        return 1;
+    if (checkGames > 0 && check(index, checkGames) != 0)
+        return 1;
+    return 0;
+}
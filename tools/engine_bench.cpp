@@ -0,0 +1,273 @@
+/*
+    Engine benchmark: generic jump-table engine vs StaticEngine<G>.
+
+    Plays the same number of pseudo-random games on every board with both
+    engines and reports positions per second. Before timing, a checking
+    pass walks random games with the specialized engine and compares its
+    move counts, game-over test and symmetry images against the generic
+    engine, so a speedup can't come from a wrong answer.
+
+    The second part times the wide-bitset engine on 100x100 and 256x256
+    cross boards with each row kernel the CPU supports, against a naive
+    cell-by-cell generator, after checking that all of them agree.
+
+    Usage: engine_bench [games per board] [wide-board positions]
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <chrono>
+#include "bitboard.h"
+#include "static_engine.h"
+#include "wide_board.h"
+
+// Small fast PRNG so the benchmark measures the engine, not rand()
+struct XorShift {
+    uint64_t state;
+    uint64_t next() {
+        state ^= state << 13;
+        state ^= state >> 7;
+        state ^= state << 17;
+        return state;
+    }
+};
+
+static double secondsSince(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+// Reference image of a position under a symmetry, one hole at a time
+static Bitboard transformSlow(const Geometry &geo, Bitboard pegs, int s) {
+    Bitboard out = 0;
+    for (int h = 0; h < geo.numHoles; h++) {
+        if (bbTest(pegs, h))
+            out |= bbBit(geo.symmetry[s][h]);
+    }
+    return out;
+}
+
+template <GeometryId G>
+struct Bench {
+    typedef StaticEngine<G> Engine;
+
+    static bool check(int games) {
+        const Geometry &geo = getGeometry(G);
+        XorShift rng = { 12345 };
+        Move moves[MAX_JUMPS];
+        for (int g = 0; g < games; g++) {
+            Board b = initialBoard(geo, geo.defaultEmpty);
+            while (true) {
+                int n = Engine::generateMoves(b.pegs, moves);
+                if (n != countMoves(geo, b) || Engine::isGameOver(b.pegs) != !hasAnyMove(geo, b))
+                    return false;
+                for (int i = 0; i < n; i++) {
+                    if (!isLegalMove(geo, b, moves[i]))
+                        return false;
+                }
+                Bitboard smallest = b.pegs;
+                for (int s = 0; s < geo.numSymmetries; s++) {
+                    Bitboard image = transformSlow(geo, b.pegs, s);
+                    if (Engine::transform(b.pegs, s) != image)
+                        return false;
+                    smallest = image < smallest ? image : smallest;
+                }
+                if (Engine::canonical(b.pegs) != smallest)
+                    return false;
+                if (n == 0)
+                    break;
+                Engine::applyMove(b.pegs, moves[rng.next() % n]);
+            }
+        }
+        return true;
+    }
+
+    static double generic(int games, uint64_t &positions) {
+        const Geometry &geo = getGeometry(G);
+        XorShift rng = { 88172645463325252ULL };
+        Move moves[MAX_JUMPS];
+        positions = 0;
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        for (int g = 0; g < games; g++) {
+            Board b = initialBoard(geo, geo.defaultEmpty);
+            int n;
+            while ((n = generateMoves(geo, b, moves)) > 0) {
+                applyMove(geo, b, moves[rng.next() % n]);
+                positions++;
+            }
+        }
+        return secondsSince(start);
+    }
+
+    static double specialized(int games, uint64_t &positions) {
+        XorShift rng = { 88172645463325252ULL };
+        Move moves[MAX_JUMPS];
+        positions = 0;
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        for (int g = 0; g < games; g++) {
+            Bitboard pegs = Engine::HOLES & ~bbBit(Engine::geo.defaultEmpty);
+            int n;
+            while ((n = Engine::generateMoves(pegs, moves)) > 0) {
+                Engine::applyMove(pegs, moves[rng.next() % n]);
+                positions++;
+            }
+        }
+        return secondsSince(start);
+    }
+
+    static int run(int games) {
+        const Geometry &geo = getGeometry(G);
+        if (!check(games / 100 + 1)) {
+            printf("%-11s specialized engine disagrees with the generic engine\n", geo.name);
+            return 1;
+        }
+        uint64_t genericPositions, specializedPositions;
+        double genericTime = generic(games, genericPositions);
+        double specializedTime = specialized(games, specializedPositions);
+        double genericRate = genericPositions / genericTime / 1e6;
+        double specializedRate = specializedPositions / specializedTime / 1e6;
+        printf("%-11s %6d %7d %12.2f %12.2f %8.2fx\n", geo.name, geo.numJumps, Engine::NUM_GROUPS,
+               genericRate, specializedRate, specializedRate / genericRate);
+        return 0;
+    }
+};
+
+/* ################################################################# */
+// Wide boards //
+
+// Reference move generation, one cell at a time
+static void naiveWideMoves(const WideBoard &b, std::vector<WideMove> &moves) {
+    moves.clear();
+    for (int r = 0; r < b.height(); r++) {
+        for (int c = 0; c < b.width(); c++) {
+            for (int d = 0; d < WIDE_DIRECTIONS; d++) {
+                WideMove m = { (uint8_t)r, (uint8_t)c, (uint8_t)d };
+                if (b.isLegal(m))
+                    moves.push_back(m);
+            }
+        }
+    }
+}
+
+static bool naiveWideHasMove(const WideBoard &b) {
+    for (int r = 0; r < b.height(); r++) {
+        for (int c = 0; c < b.width(); c++) {
+            for (int d = 0; d < WIDE_DIRECTIONS; d++) {
+                WideMove m = { (uint8_t)r, (uint8_t)c, (uint8_t)d };
+                if (b.isLegal(m))
+                    return true;
+            }
+        }
+    }
+    return false;
+}
+
+static bool sameMoves(const std::vector<WideMove> &a, const std::vector<WideMove> &b) {
+    if (a.size() != b.size())
+        return false;
+    for (size_t i = 0; i < a.size(); i++) {
+        if (a[i].row != b[i].row || a[i].col != b[i].col || a[i].dir != b[i].dir)
+            return false;
+    }
+    return true;
+}
+
+// Walk a random game comparing every kernel, the incremental move set and
+// the naive generator at each position, and the incremental Zobrist key
+// with the key of the same position built from scratch
+static bool checkWide(WideBoard b, int steps) {
+    XorShift rng = { 12345 };
+    std::vector<WideMove> reference, naive, moves;
+    WideMoveSet live;
+    live.init(b);
+    for (int s = 0; s < steps; s++) {
+        wideSelectKernel(WIDE_KERNEL_SCALAR);
+        b.generateMoves(reference);
+        naiveWideMoves(b, naive);
+        if (reference.size() != naive.size() || (int)naive.size() != live.count())
+            return false;
+        for (size_t i = 0; i < reference.size(); i++) {
+            if (!b.isLegal(reference[i]) || !live.contains(reference[i]))
+                return false;
+        }
+        for (int k = WIDE_KERNEL_SSE2; k <= WIDE_KERNEL_AVX2; k++) {
+            if (!wideSelectKernel((WideKernel)k))
+                continue;
+            b.generateMoves(moves);
+            if (!sameMoves(moves, reference) || b.hasAnyMove() != !reference.empty())
+                return false;
+        }
+        std::vector<std::string> rows;
+        std::string text = b.toString();
+        for (size_t pos = 0; pos < text.size(); pos = text.find('\n', pos) + 1)
+            rows.push_back(text.substr(pos, text.find('\n', pos) - pos));
+        WideBoard rebuilt;
+        if (!rebuilt.parse(rows) || rebuilt.hash() != b.hash())
+            return false;
+        if (reference.empty())
+            break;
+        WideMove m = reference[rng.next() % reference.size()];
+        b.applyMove(m);
+        live.update(b, m);
+    }
+    return true;
+}
+
+// Seconds to generate every move and test for game over along a random game;
+// kernel < 0 times the naive generator
+static double timeWide(WideBoard b, int steps, int kernel) {
+    XorShift rng = { 88172645463325252ULL };
+    std::vector<WideMove> moves;
+    moves.reserve(4 * b.holeCount());
+    if (kernel >= 0)
+        wideSelectKernel((WideKernel)kernel);
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    for (int s = 0; s < steps; s++) {
+        bool over;
+        if (kernel >= 0) {
+            b.generateMoves(moves);
+            over = !b.hasAnyMove();
+        } else {
+            naiveWideMoves(b, moves);
+            over = !naiveWideHasMove(b);
+        }
+        if (over)
+            break;
+        b.applyMove(moves[rng.next() % moves.size()]);
+    }
+    return secondsSince(start);
+}
+
+static int benchWide(int size, int steps) {
+    WideBoard board = WideBoard::cross(size, size / 3);
+    WideKernel best = wideBestKernel();
+    if (!checkWide(board, steps / 10 + 1)) {
+        printf("%dx%d wide kernels disagree with the naive generator\n", size, size);
+        return 1;
+    }
+    printf("%3dx%-3d %6d %10.1f", size, size, board.holeCount(), steps / timeWide(board, steps, -1) / 1e3);
+    for (int k = WIDE_KERNEL_SCALAR; k <= WIDE_KERNEL_AVX2; k++) {
+        if (wideSelectKernel((WideKernel)k))
+            printf(" %10.1f", steps / timeWide(board, steps, k) / 1e3);
+        else
+            printf(" %10s", "-");
+    }
+    printf("\n");
+    wideSelectKernel(best);
+    return 0;
+}
+
+int main(int argc, char *argv[]) {
+    int games = argc > 1 ? atoi(argv[1]) : 200000;
+    int wideSteps = argc > 2 ? atoi(argv[2]) : 2000;
+    printf("Random playouts, %d games per board (M positions/s)\n\n", games);
+    printf("%-11s %6s %7s %12s %12s %9s\n", "board", "jumps", "groups", "generic", "specialized", "speedup");
+    int failed = 0;
+    for (int i = 0; i < NUM_GEOMETRIES; i++)
+        failed |= dispatchGeometry<Bench>((GeometryId)i, games);
+
+    printf("\nWide boards, full move generation + game-over test, %d positions (K positions/s)\n\n", wideSteps);
+    printf("%-7s %6s %10s %10s %10s %10s\n", "board", "holes", "naive", "scalar", "sse2", "avx2");
+    failed |= benchWide(100, wideSteps);
+    failed |= benchWide(256, wideSteps);
+    return failed;
+}
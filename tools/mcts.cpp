@@ -0,0 +1,149 @@
+/*
+    Play a whole game with the Monte Carlo tree search player (see mcts.h).
+
+    Each move is decided by a search with the given budget, on one of the
+    bitboard boards or, with --size, on a wide cross. Prints the moves, the
+    pegs left at the end and the playouts per second.
+
+    Usage: mcts [--board NAME] [--empty HOLE] [--size N] [--arm N]
+                [--ms MS] [--playouts N] [--threads N] [--random]
+                [--exploration C] [--virtual-loss N] [--seed N] [--quiet]
+
+      --size N, --arm N  play on a wide cross of N x N holes with arms N holes
+                         wide (default a third of the size)
+      --ms MS            time budget per move in milliseconds (default 200)
+      --playouts N       playout budget per move instead
+      --threads N        threads growing the tree (default 1)
+      --random           uniformly random playouts instead of heuristic ones
+      --quiet            print only the summary
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "mcts.h"
+#include "position.h"
+
+static void usage() {
+    fprintf(stderr, "Usage: mcts [--board NAME] [--empty HOLE] [--size N] [--arm N]\n"
+                    "            [--ms MS] [--playouts N] [--threads N] [--random]\n"
+                    "            [--exploration C] [--virtual-loss N] [--seed N] [--quiet]\n");
+}
+
+static void printSummary(int pegs, int moves, uint64_t playouts, double seconds) {
+    printf("\n%d pegs left after %d moves, %llu playouts in %.2f s (%.0f playouts/s)\n", pegs, moves,
+           (unsigned long long)playouts, seconds, playouts / (seconds > 0 ? seconds : 1e-9));
+}
+
+static int playBitboard(GeometryId board, int emptyHole, const MctsOptions &options, bool quiet) {
+    const Geometry &geo = getGeometry(board);
+    if (emptyHole < 0 || emptyHole >= geo.numHoles)
+        emptyHole = geo.defaultEmpty;
+    Bitboard pegs = initialBoard(geo, emptyHole).pegs;
+    printf("%s, %d pegs\n%s\n\n", geo.name, bbPopCount(pegs), formatPosition(geo, pegs).c_str());
+
+    MctsPlayer player;
+    uint64_t playouts = 0;
+    double seconds = 0;
+    int moves = 0;
+    while (true) {
+        player.setPosition(board, pegs);
+        player.search(options);
+        Move m;
+        if (!player.bestMove(m))
+            break;
+        const MctsStats &stats = player.stats();
+        playouts += stats.playouts;
+        seconds += stats.seconds;
+        const Jump &j = moveJump(geo, m);
+        pegs ^= j.mask;
+        moves++;
+        if (!quiet)
+            printf("  %2d. %2d,%-2d -> %2d,%-2d   %8llu playouts, best line %d pegs\n", moves,
+                   geo.holeRow[j.from], geo.holeCol[j.from], geo.holeRow[j.to], geo.holeCol[j.to],
+                   (unsigned long long)stats.playouts, stats.bestPegs);
+    }
+    printf("\n%s\n", formatPosition(geo, pegs).c_str());
+    printSummary(bbPopCount(pegs), moves, playouts, seconds);
+    return 0;
+}
+
+static int playWide(int size, int arm, const MctsOptions &options, bool quiet) {
+    WideBoard board = WideBoard::cross(size, arm > 0 ? arm : size / 3);
+    printf("%dx%d cross, %d pegs\n", size, size, board.pegCount());
+
+    WideMctsPlayer player;
+    uint64_t playouts = 0;
+    double seconds = 0;
+    int moves = 0;
+    while (true) {
+        player.setPosition(board);
+        player.search(options);
+        WideMove m;
+        if (!player.bestMove(m))
+            break;
+        const MctsStats &stats = player.stats();
+        playouts += stats.playouts;
+        seconds += stats.seconds;
+        board.applyMove(m);
+        moves++;
+        if (!quiet && moves % 25 == 0)
+            printf("  move %4d   %6d pegs, best line %d pegs\n", moves, board.pegCount(), stats.bestPegs);
+    }
+    printSummary(board.pegCount(), moves, playouts, seconds);
+    return 0;
+}
+
+int main(int argc, char *argv[]) {
+    GeometryId board = GEOMETRY_ENGLISH;
+    int emptyHole = -1;
+    int size = 0, arm = -1;
+    bool quiet = false;
+    MctsOptions options = defaultMctsOptions();
+    options.seconds = 0.2;
+
+    for (int i = 1; i < argc; i++) {
+        bool hasValue = i + 1 < argc;
+        if (strcmp(argv[i], "--board") == 0 && hasValue) {
+            if (!findGeometry(argv[++i], board)) {
+                fprintf(stderr, "Unknown board '%s'\n", argv[i]);
+                return 2;
+            }
+        } else if (strcmp(argv[i], "--empty") == 0 && hasValue) {
+            emptyHole = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--size") == 0 && hasValue) {
+            size = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--arm") == 0 && hasValue) {
+            arm = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--ms") == 0 && hasValue) {
+            options.seconds = atof(argv[++i]) / 1000;
+        } else if (strcmp(argv[i], "--playouts") == 0 && hasValue) {
+            options.playouts = strtoull(argv[++i], NULL, 10);
+            options.seconds = 0;
+        } else if (strcmp(argv[i], "--threads") == 0 && hasValue) {
+            options.threads = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--random") == 0) {
+            options.heuristicPlayouts = false;
+        } else if (strcmp(argv[i], "--exploration") == 0 && hasValue) {
+            options.exploration = atof(argv[++i]);
+        } else if (strcmp(argv[i], "--virtual-loss") == 0 && hasValue) {
+            options.virtualLoss = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--seed") == 0 && hasValue) {
+            options.seed = strtoull(argv[++i], NULL, 10);
+        } else if (strcmp(argv[i], "--quiet") == 0) {
+            quiet = true;
+        } else {
+            usage();
+            return 2;
+        }
+    }
+
+    if (size) {
+        if (size < 3 || size > WIDE_MAX_SIZE) {
+            fprintf(stderr, "Size must be between 3 and %d\n", WIDE_MAX_SIZE);
+            return 2;
+        }
+        return playWide(size, arm, options, quiet);
+    }
+    return playBitboard(board, emptyHole, options, quiet);
+}
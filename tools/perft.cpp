@@ -0,0 +1,275 @@
+/*
+    Perft: count every position reachable in exactly N moves.
+
+    The leaf count for a given board, start position and depth is fixed, so
+    it doubles as a correctness oracle for move generation and as a
+    standing throughput number. The count is run once on one thread and
+    once split across worker threads (the subtrees below the first two
+    moves are handed out one at a time), and both report leaves per second.
+
+    Usage: perft [--board NAME] [--empty HOLE | --position TEXT] [--depth N]
+                 [--threads N] [--divide] [--check] [--unique]
+
+      --position TEXT  start from a position in the format of position.h
+      --divide         print the leaf count below each first move
+      --check          also count through GameState::makeMove/undo,
+                       verifying its Zobrist key at every node, and
+                       compare with the specialized engine
+      --unique         also count the distinct positions at each depth,
+                       and how many remain once symmetric positions are
+                       merged into their canonical form
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <unordered_set>
+#include <vector>
+#include "static_engine.h"
+#include "game_state.h"
+#include "position.h"
+
+struct Options {
+    GeometryId board;
+    Bitboard pegs;
+    int depth;
+    int threads;
+    bool divide;
+    bool check;
+    bool unique;
+};
+
+static double secondsSince(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+// Reference count through the game rules, one makeMove/undo per node. The
+// incremental Zobrist key is checked against a full rehash at every node;
+// a mismatch makes the count come out as zero.
+static uint64_t perftGameState(GameState &game, int depth) {
+    const Geometry &geo = game.geometry();
+    if (game.hash() != zobristHash(geo, game.board().pegs))
+        return 0;
+    if (depth == 0)
+        return 1;
+    uint64_t leaves = 0;
+    for (int i = 0; i < geo.numJumps; i++) {
+        Move m = { geo.jumps[i].from, geo.jumps[i].dir };
+        if (!game.makeMove(m))
+            continue;
+        leaves += perftGameState(game, depth - 1);
+        game.undo();
+    }
+    return leaves;
+}
+
+template <GeometryId G>
+struct Perft {
+    typedef StaticEngine<G> Engine;
+
+    // The last ply is counted without being played
+    static uint64_t count(Bitboard pegs, int depth) {
+        if (depth == 0)
+            return 1;
+        if (depth == 1)
+            return Engine::countMoves(pegs);
+        Move moves[MAX_JUMPS];
+        int n = Engine::generateMoves(pegs, moves);
+        uint64_t leaves = 0;
+        for (int i = 0; i < n; i++)
+            leaves += count(pegs ^ Engine::moveMask(moves[i]), depth - 1);
+        return leaves;
+    }
+
+    // One unit of parallel work: a position after the first one or two moves
+    struct Task {
+        Bitboard pegs;
+        int root;  // Index of the first move
+    };
+
+    // Leaves below each first move, counted by the given number of threads
+    static void countSplit(Bitboard pegs, int depth, int threads, std::vector<uint64_t> &perRoot) {
+        Move roots[MAX_JUMPS];
+        int numRoots = Engine::generateMoves(pegs, roots);
+        perRoot.assign(numRoots, 0);
+        if (depth == 0)
+            return;
+
+        std::vector<Task> tasks;
+        int taskDepth = depth >= 3 ? 2 : 1;
+        for (int r = 0; r < numRoots; r++) {
+            Bitboard after = pegs ^ Engine::moveMask(roots[r]);
+            if (taskDepth == 1) {
+                tasks.push_back(Task{ after, r });
+                continue;
+            }
+            Move replies[MAX_JUMPS];
+            int n = Engine::generateMoves(after, replies);
+            for (int i = 0; i < n; i++)
+                tasks.push_back(Task{ after ^ Engine::moveMask(replies[i]), r });
+        }
+
+        // Workers take the next task off a shared counter and keep their own totals
+        std::atomic<size_t> next(0);
+        std::vector<std::vector<uint64_t> > partial(threads, std::vector<uint64_t>(numRoots, 0));
+        std::vector<std::thread> workers;
+        for (int t = 0; t < threads; t++) {
+            workers.push_back(std::thread([&, t]() {
+                size_t i;
+                while ((i = next.fetch_add(1)) < tasks.size())
+                    partial[t][tasks[i].root] += count(tasks[i].pegs, depth - taskDepth);
+            }));
+        }
+        for (size_t t = 0; t < workers.size(); t++)
+            workers[t].join();
+        for (int t = 0; t < threads; t++) {
+            for (int r = 0; r < numRoots; r++)
+                perRoot[r] += partial[t][r];
+        }
+    }
+
+    // Distinct positions and canonical classes after each number of moves,
+    // found layer by layer
+    static void printUnique(Bitboard pegs, int depth) {
+        std::unordered_set<Bitboard> layer = { pegs };
+        printf("\n%-8s %16s %16s %8s\n", "depth", "positions", "canonical", "ratio");
+        for (int d = 0; d <= depth && !layer.empty(); d++) {
+            std::unordered_set<Bitboard> classes;
+            for (Bitboard p : layer)
+                classes.insert(Engine::canonical(p));
+            printf("%-8d %16llu %16llu %8.2f\n", d, (unsigned long long)layer.size(),
+                   (unsigned long long)classes.size(), (double)layer.size() / classes.size());
+            if (d == depth)
+                break;
+            std::unordered_set<Bitboard> next;
+            Move moves[MAX_JUMPS];
+            for (Bitboard p : layer) {
+                int n = Engine::generateMoves(p, moves);
+                for (int i = 0; i < n; i++)
+                    next.insert(p ^ Engine::moveMask(moves[i]));
+            }
+            layer.swap(next);
+        }
+    }
+
+    static void printDivide(Bitboard pegs, const std::vector<uint64_t> &perRoot) {
+        const Geometry &geo = Engine::geo;
+        Move roots[MAX_JUMPS];
+        Engine::generateMoves(pegs, roots);
+        for (size_t r = 0; r < perRoot.size(); r++) {
+            const Jump &j = moveJump(geo, roots[r]);
+            printf("  %2d,%-2d -> %2d,%-2d %16llu\n", geo.holeRow[j.from], geo.holeCol[j.from],
+                   geo.holeRow[j.to], geo.holeCol[j.to], (unsigned long long)perRoot[r]);
+        }
+        printf("\n");
+    }
+
+    static int run(const Options &opt) {
+        printf("%s, depth %d, %d pegs\n%s\n\n", Engine::geo.name, opt.depth, bbPopCount(opt.pegs),
+               formatPosition(Engine::geo, opt.pegs).c_str());
+
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        uint64_t single = count(opt.pegs, opt.depth);
+        double singleTime = secondsSince(start);
+
+        std::vector<uint64_t> perRoot;
+        start = std::chrono::steady_clock::now();
+        countSplit(opt.pegs, opt.depth, opt.threads, perRoot);
+        double multiTime = secondsSince(start);
+        uint64_t multi = 0;
+        for (size_t r = 0; r < perRoot.size(); r++)
+            multi += perRoot[r];
+        if (opt.depth == 0)
+            multi = 1;
+
+        if (opt.divide)
+            printDivide(opt.pegs, perRoot);
+
+        printf("%-8s %16s %10s %14s\n", "threads", "leaves", "seconds", "M leaves/s");
+        printf("%-8d %16llu %10.3f %14.2f\n", 1, (unsigned long long)single, singleTime,
+               single / singleTime / 1e6);
+        printf("%-8d %16llu %10.3f %14.2f\n", opt.threads, (unsigned long long)multi, multiTime,
+               multi / multiTime / 1e6);
+
+        int failed = single != multi;
+        if (opt.check) {
+            GameState game(G);
+            game.setPosition(opt.pegs);
+            start = std::chrono::steady_clock::now();
+            uint64_t reference = perftGameState(game, opt.depth);
+            double referenceTime = secondsSince(start);
+            printf("%-8s %16llu %10.3f %14.2f\n", "rules", (unsigned long long)reference,
+                   referenceTime, reference / referenceTime / 1e6);
+            failed |= reference != single;
+        }
+        if (opt.unique)
+            printUnique(opt.pegs, opt.depth);
+        if (failed)
+            printf("\nMISMATCH: leaf counts differ\n");
+        return failed;
+    }
+};
+
+static void usage() {
+    fprintf(stderr, "Usage: perft [--board NAME] [--empty HOLE | --position TEXT] [--depth N]\n"
+                    "             [--threads N] [--divide] [--check] [--unique]\n");
+}
+
+int main(int argc, char *argv[]) {
+    Options opt;
+    opt.board = GEOMETRY_ENGLISH;
+    opt.depth = 6;
+    opt.threads = (int)std::thread::hardware_concurrency();
+    opt.divide = false;
+    opt.check = false;
+    opt.unique = false;
+    int emptyHole = -1;
+    const char *position = NULL;
+
+    for (int i = 1; i < argc; i++) {
+        bool hasValue = i + 1 < argc;
+        if (strcmp(argv[i], "--board") == 0 && hasValue) {
+            if (!findGeometry(argv[++i], opt.board)) {
+                fprintf(stderr, "Unknown board '%s'\n", argv[i]);
+                return 2;
+            }
+        } else if (strcmp(argv[i], "--empty") == 0 && hasValue) {
+            emptyHole = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--position") == 0 && hasValue) {
+            position = argv[++i];
+        } else if (strcmp(argv[i], "--depth") == 0 && hasValue) {
+            opt.depth = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--threads") == 0 && hasValue) {
+            opt.threads = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--divide") == 0) {
+            opt.divide = true;
+        } else if (strcmp(argv[i], "--check") == 0) {
+            opt.check = true;
+        } else if (strcmp(argv[i], "--unique") == 0) {
+            opt.unique = true;
+        } else {
+            usage();
+            return 2;
+        }
+    }
+    if (opt.threads < 1)
+        opt.threads = 1;
+    if (opt.depth < 0)
+        opt.depth = 0;
+
+    const Geometry &geo = getGeometry(opt.board);
+    if (position) {
+        if (!parsePosition(geo, position, opt.pegs)) {
+            fprintf(stderr, "Position does not match the %s board (%dx%d grid)\n", geo.name, geo.rows, geo.cols);
+            return 2;
+        }
+    } else {
+        if (emptyHole < 0 || emptyHole >= geo.numHoles)
+            emptyHole = geo.defaultEmpty;
+        opt.pegs = initialBoard(geo, emptyHole).pegs;
+    }
+    return dispatchGeometry<Perft>(opt.board, opt);
+}
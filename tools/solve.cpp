@@ -0,0 +1,515 @@
+/*
+    Solve a position from the command line.
+
+    Prints whether the position can be reduced to a single peg, the winning
+    line if there is one, and the nodes and time the search took.
+
+    Usage: solve [--board NAME] [--empty HOLE | --position TEXT]
+                 [--target HOLE] [--nodes N] [--prune RULES] [--compare]
+                 [--threads N] [--moves] [--count] [--fewest] [--cache FILE]
+                 [--catalog FILE] [--bidirectional] [--check N]
+
+      --position TEXT  start from a position in the format of position.h
+      --target HOLE    the last peg must end on this hole
+      --nodes N        give up after N expanded positions
+      --prune RULES    pruning rules: all (default), none, pagodas or classes
+      --compare        solve once per set of pruning rules, each with an
+                       empty dead table, and tabulate nodes and time
+      --threads N      search with N worker threads (default 1) and show
+                       the positions each one expanded
+      --moves          find a line with the fewest moves, a chain of
+                       jumps by one peg counting as one move
+      --count          count the winning jump sequences exactly, on
+                       --threads threads
+      --fewest         find the fewest pegs the position can be reduced
+                       to and a line reaching them
+      --cache FILE     start from the dead-position table saved in FILE,
+                       if there is one, and save the table there after
+                       the search; plain search only, refused with
+                       --compare and every other mode
+      --catalog FILE   solve every pair of start hole and finish hole on
+                       the board (with --moves, for the fewest moves),
+                       --threads N at a time (default all cores), write
+                       one CSV line per pair to FILE and print the matrix
+                       of solvable pairs; --nodes and --prune apply to
+                       each pair
+      --bidirectional  search back from the goal, breadth first, and depth
+                       first from the start until the two meet; with
+                       --compare, also forward only and tabulate nodes,
+                       positions and time
+      --check N        compare --moves with a brute-force search on N
+                       positions played backwards from one peg (on
+                       --target if given) and report any disagreement
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <algorithm>
+#include <chrono>
+#include <thread>
+#include "bidirectional.h"
+#include "catalog.h"
+#include "solver.h"
+#include "move_solver.h"
+#include "fewest_pegs.h"
+#include "position.h"
+#include "solution_count.h"
+
+static const char *const PRUNING_NAMES[] = { "none", "pagodas", "classes", "all" };
+
+static void usage() {
+    fprintf(stderr, "Usage: solve [--board NAME] [--empty HOLE | --position TEXT]\n"
+                    "             [--target HOLE] [--nodes N] [--prune RULES] [--compare]\n"
+                    "             [--threads N] [--moves] [--count] [--fewest] [--cache FILE]\n"
+                    "             [--catalog FILE] [--bidirectional] [--check N]\n");
+}
+
+static bool findPruning(const char *name, int &flags) {
+    for (int f = PRUNE_NONE; f <= PRUNE_ALL; f++) {
+        if (strcmp(name, PRUNING_NAMES[f]) == 0) {
+            flags = f;
+            return true;
+        }
+    }
+    return false;
+}
+
+static const char *resultName(SolveResult result) {
+    if (result == SOLVE_WIN)
+        return "solved";
+    return result == SOLVE_DEAD ? "no solution" : "gave up";
+}
+
+static void compare(GeometryId board, Bitboard pegs, int targetHole, uint64_t nodeLimit, int threads) {
+    printf("%-8s %12s %14s %14s %10s  %s\n", "pruning", "nodes", "dead hits", "pagoda cuts", "seconds", "result");
+    for (int f = PRUNE_NONE; f <= PRUNE_ALL; f++) {
+        Solver solver;
+        solver.setPruning(f);
+        solver.setThreads(threads);
+        std::vector<Move> line;
+        SolveResult result = solver.solve(board, pegs, line, targetHole, nodeLimit);
+        const SolverStats &stats = solver.stats();
+        printf("%-8s %12llu %14llu %14llu %10.3f  %s\n", PRUNING_NAMES[f], (unsigned long long)stats.nodes,
+               (unsigned long long)stats.deadHits, (unsigned long long)stats.pagodaCuts, stats.seconds,
+               resultName(result));
+    }
+}
+
+// Shortest line in moves, one line of output per move
+static int solveMoves(GeometryId board, Bitboard pegs, int targetHole, uint64_t nodeLimit) {
+    const Geometry &geo = getGeometry(board);
+    MoveSolver solver;
+    std::vector<Move> line;
+    SolveResult result = solver.solve(board, pegs, line, targetHole, nodeLimit);
+    const MoveSolverStats &stats = solver.stats();
+
+    if (result == SOLVE_WIN) {
+        printf("Solved in %d moves (%d jumps):", countChainMoves(geo, line), (int)line.size());
+        int moves = 0, landed = -1;
+        for (size_t i = 0; i < line.size(); i++) {
+            const Jump &j = moveJump(geo, line[i]);
+            if (j.from != landed)
+                printf("\n  %2d. %2d,%-2d", ++moves, geo.holeRow[j.from], geo.holeCol[j.from]);
+            printf(" -> %2d,%-2d", geo.holeRow[j.to], geo.holeCol[j.to]);
+            landed = j.to;
+        }
+        printf("\n");
+    } else if (result == SOLVE_DEAD) {
+        printf("No solution\n");
+    } else {
+        printf("Gave up after %llu nodes, at least %d moves\n", (unsigned long long)nodeLimit, stats.bound);
+    }
+    printf("\n%llu nodes, %llu bound-table hits, %d iterations, %.3f s\n", (unsigned long long)stats.nodes,
+           (unsigned long long)stats.tableHits, stats.iterations, stats.seconds);
+    return result == SOLVE_UNKNOWN ? 1 : 0;
+}
+
+// Positions reached from pegs by one move, each chain of jumps by one peg
+// stopping after any of its jumps
+static void addMoves(const Geometry &geo, Bitboard pegs, int hole, std::vector<Bitboard> &next) {
+    for (int d = 0; d < geo.numDirections; d++) {
+        int k = geo.jumpIndex[hole][d];
+        if (k < 0)
+            continue;
+        const Jump &j = geo.jumps[k];
+        if (bbTest(pegs, j.over) && !bbTest(pegs, j.to)) {
+            next.push_back(pegs ^ j.mask);
+            addMoves(geo, pegs ^ j.mask, j.to, next);
+        }
+    }
+}
+
+// Fewest moves from pegs to one peg on goal by trying every move of every
+// position, one layer of moves at a time; -1 if there is no such line.
+// Only for positions of a few pegs.
+static int bruteForceMoves(const Geometry &geo, Bitboard pegs, Bitboard goal) {
+    std::vector<Bitboard> layer(1, pegs);
+    for (int moves = 0; !layer.empty(); moves++) {
+        std::vector<Bitboard> next;
+        for (size_t i = 0; i < layer.size(); i++) {
+            if (bbPopCount(layer[i]) == 1 && (layer[i] & goal))
+                return moves;
+            for (Bitboard p = layer[i]; p; p &= p - 1)
+                addMoves(geo, layer[i], bbLowest(p), next);
+        }
+        std::sort(next.begin(), next.end());
+        next.erase(std::unique(next.begin(), next.end()), next.end());
+        layer.swap(next);
+    }
+    return -1;
+}
+
+// Compare the move solver with the brute-force search on positions played
+// backwards from one peg, every other one with that peg's hole as target
+// unless targetHole is given; returns the number of disagreements
+static int checkMoves(GeometryId board, int targetHole, int positions) {
+    const Geometry &geo = getGeometry(board);
+    MoveSolver solvers[2];
+    uint64_t rng = 2463534242ULL;
+    int mismatches = 0;
+    for (int i = 0; i < positions; i++) {
+        rng ^= rng << 13;
+        rng ^= rng >> 7;
+        rng ^= rng << 17;
+        int last = targetHole >= 0 ? targetHole : (int)(rng % geo.numHoles);
+        int target = targetHole >= 0 || i % 2 == 0 ? last : -1;
+        // An undone jump from a over b to c empties c and fills a and b
+        Bitboard pegs = bbBit(last);
+        int jumps = 2 + (int)(rng >> 32) % 9;
+        for (int k = 0; k < jumps; k++) {
+            int undoable[MAX_JUMPS], n = 0;
+            for (int m = 0; m < geo.numJumps; m++) {
+                const Jump &j = geo.jumps[m];
+                if (bbTest(pegs, j.to) && !bbTest(pegs, j.from) && !bbTest(pegs, j.over))
+                    undoable[n++] = m;
+            }
+            rng ^= rng << 13;
+            rng ^= rng >> 7;
+            rng ^= rng << 17;
+            if (n > 0)
+                pegs ^= geo.jumps[undoable[rng % n]].mask;
+        }
+        if (bbPopCount(pegs) < 2)
+            continue;
+
+        std::vector<Move> line;
+        MoveSolver &solver = solvers[target >= 0];
+        SolveResult result = solver.solve(board, pegs, line, target);
+        int found = result == SOLVE_WIN ? countChainMoves(geo, line) : -1;
+        Bitboard left = pegs;
+        for (size_t m = 0; m < line.size(); m++) {
+            const Jump &j = moveJump(geo, line[m]);
+            if (!bbTest(left, j.from) || !bbTest(left, j.over) || bbTest(left, j.to))
+                found = -2;
+            left ^= j.mask;
+        }
+        if (found >= 0 && (bbPopCount(left) != 1 || (target >= 0 && left != bbBit(target))))
+            found = -2;
+        int fewest = bruteForceMoves(geo, pegs, target >= 0 ? bbBit(target) : geo.allHoles);
+        if (found != fewest) {
+            printf("Mismatch on %s (target %d): solver %d moves, brute force %d\n",
+                   formatPosition(geo, pegs).c_str(), target, found, fewest);
+            mismatches++;
+        }
+    }
+    printf("Checked %d positions against a brute-force search: %d mismatches\n", positions, mismatches);
+    return mismatches;
+}
+
+// Fewest pegs left and a line to them
+static int solveFewest(GeometryId board, Bitboard pegs, uint64_t nodeLimit) {
+    const Geometry &geo = getGeometry(board);
+    FewestPegsSolver solver;
+    int best;
+    std::vector<Move> line;
+    SolveResult result = solver.solve(board, pegs, best, line, nodeLimit);
+    const FewestPegsStats &stats = solver.stats();
+
+    printf("%s %d pegs in %d jumps:\n", result == SOLVE_WIN ? "Fewest" : "Gave up, best found", best,
+           (int)line.size());
+    for (size_t i = 0; i < line.size(); i++) {
+        const Jump &j = moveJump(geo, line[i]);
+        printf("  %2d. %2d,%-2d -> %2d,%-2d\n", (int)i + 1, geo.holeRow[j.from], geo.holeCol[j.from],
+               geo.holeRow[j.to], geo.holeCol[j.to]);
+    }
+    for (size_t i = 0; i < line.size(); i++)
+        pegs ^= moveJump(geo, line[i]).mask;
+    printf("%s\n", formatPosition(geo, pegs).c_str());
+    printf("\n%llu nodes, %llu table hits, %llu bound cuts, lower bound %d, %.3f s\n",
+           (unsigned long long)stats.nodes, (unsigned long long)stats.tableHits,
+           (unsigned long long)stats.boundCuts, stats.lowerBound, stats.seconds);
+    return result == SOLVE_UNKNOWN ? 1 : 0;
+}
+
+static void printCatalogJob(const CatalogEntry &e, int done, int total, void *user) {
+    const Geometry &geo = *(const Geometry *)user;
+    printf("%4d/%-4d %2d,%-2d -> %2d,%-2d  %-11s %3d moves %12llu nodes %9.3f s\n", done, total,
+           geo.holeRow[e.start], geo.holeCol[e.start], geo.holeRow[e.finish], geo.holeCol[e.finish],
+           resultName(e.result), e.moves, (unsigned long long)e.nodes, e.seconds);
+    fflush(stdout);
+}
+
+// Every pair of start and finish hole: one CSV line each in path, and the
+// matrix of the solvable ones on stdout
+static int catalog(GeometryId board, const char *path, const CatalogOptions &options) {
+    static const char *const CSV_RESULTS[] = { "win", "dead", "unknown" };
+    const Geometry &geo = getGeometry(board);
+    FILE *f = fopen(path, "w");
+    if (!f) {
+        fprintf(stderr, "Cannot write %s\n", path);
+        return 1;
+    }
+    printf("%s, %d x %d pairs on %d threads\n\n", geo.name, geo.numHoles, geo.numHoles, options.threads);
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    std::vector<CatalogEntry> entries = buildCatalog(board, options, printCatalogJob, (void *)&geo);
+    double wall = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    fprintf(f, "start,finish,start_row,start_col,finish_row,finish_col,result,%s,nodes,seconds,solved_as\n",
+            options.minimizeMoves ? "fewest_moves" : "moves");
+    int wins = 0, unknown = 0, searched = 0;
+    uint64_t nodes = 0;
+    double seconds = 0;
+    for (size_t i = 0; i < entries.size(); i++) {
+        const CatalogEntry &e = entries[i];
+        const CatalogEntry &as = entries[e.solvedAs];
+        fprintf(f, "%d,%d,%d,%d,%d,%d,%s,%d,%llu,%.6f,%d:%d\n", e.start, e.finish, geo.holeRow[e.start],
+                geo.holeCol[e.start], geo.holeRow[e.finish], geo.holeCol[e.finish], CSV_RESULTS[e.result], e.moves,
+                (unsigned long long)e.nodes, e.seconds, as.start, as.finish);
+        wins += e.result == SOLVE_WIN;
+        unknown += e.result == SOLVE_UNKNOWN;
+        if (e.solvedAs == (int)i) {
+            searched++;
+            nodes += e.nodes;
+            seconds += e.seconds;
+        }
+    }
+    bool written = fclose(f) == 0;
+    if (!written)
+        fprintf(stderr, "Cannot write %s\n", path);
+
+    // One row per start hole, one column per finish hole
+    printf("\nstart \\ finish (# solvable, . not, ? gave up)\n      ");
+    for (int finish = 0; finish < geo.numHoles; finish++)
+        printf("%d", finish % 10);
+    for (int start = 0; start < geo.numHoles; start++) {
+        printf("\n  %2d  ", start);
+        for (int finish = 0; finish < geo.numHoles; finish++) {
+            SolveResult result = entries[start * geo.numHoles + finish].result;
+            putchar(result == SOLVE_WIN ? '#' : result == SOLVE_DEAD ? '.' : '?');
+        }
+    }
+    printf("\n\n%d of %d pairs solvable, %d gave up; %d pairs searched for all symmetric ones\n", wins,
+           (int)entries.size(), unknown, searched);
+    printf("%llu nodes, %.3f s of search, %.3f s wall\n", (unsigned long long)nodes, seconds, wall);
+    return !written ? 1 : unknown ? 1 : 0;
+}
+
+static void printCountLayer(const char *stage, int pegs, uint64_t positions, void *) {
+    printf("%-8s %2d pegs %12llu positions\n", stage, pegs, (unsigned long long)positions);
+    fflush(stdout);
+}
+
+// Backward from the goal and forward from the start, or forward only as
+// well to compare
+static int solveMeeting(GeometryId board, Bitboard pegs, int targetHole, uint64_t nodeLimit, bool comparing) {
+    const Geometry &geo = getGeometry(board);
+    std::vector<Move> line;
+    BidirectionalStats stats;
+    SolveResult result = solveBidirectional(board, pegs, line, targetHole, BIDIRECTIONAL_MAX_POSITIONS, nodeLimit,
+                                            &stats, printCountLayer);
+    if (comparing) {
+        printf("\n%-14s %12s %14s %12s %8s %10s  %s\n", "search", "nodes", "positions", "frontier", "depths",
+               "seconds", "result");
+        for (int bidirectional = 0; bidirectional < 2; bidirectional++) {
+            BidirectionalStats run = stats;
+            SolveResult r = result;
+            std::vector<Move> ignored;
+            if (!bidirectional)
+                r = solveBidirectional(board, pegs, ignored, targetHole, 0, nodeLimit, &run);
+            char depths[32];
+            snprintf(depths, sizeof(depths), "%d+%d", run.forwardDepth, run.backwardDepth);
+            printf("%-14s %12llu %14llu %12llu %8s %10.3f  %s\n", bidirectional ? "bidirectional" : "forward only",
+                   (unsigned long long)run.nodes, (unsigned long long)run.positions,
+                   (unsigned long long)run.frontier, depths, run.seconds, resultName(r));
+        }
+    }
+
+    printf("\n");
+    if (result == SOLVE_WIN) {
+        printf("Solved in %d moves:\n", (int)line.size());
+        for (size_t i = 0; i < line.size(); i++) {
+            const Jump &j = moveJump(geo, line[i]);
+            printf("  %2d. %2d,%-2d -> %2d,%-2d\n", (int)i + 1, geo.holeRow[j.from], geo.holeCol[j.from],
+                   geo.holeRow[j.to], geo.holeCol[j.to]);
+        }
+    } else if (result == SOLVE_DEAD) {
+        printf("No solution\n");
+    } else {
+        printf("Gave up after %llu nodes\n", (unsigned long long)nodeLimit);
+    }
+    printf("\n%llu forward nodes, %llu backward positions, frontier of %llu positions %d jumps from the goal, "
+           "%.3f s\n",
+           (unsigned long long)stats.nodes, (unsigned long long)stats.positions, (unsigned long long)stats.frontier,
+           stats.backwardDepth, stats.seconds);
+    return result == SOLVE_UNKNOWN ? 1 : 0;
+}
+
+// Exact number of winning jump sequences
+static int countLines(GeometryId board, Bitboard pegs, int targetHole, int threads) {
+    SolutionCountStats stats;
+    SolutionCount count = countSolutions(board, pegs, targetHole, threads, &stats, printCountLayer);
+    printf("\n%s%s winning jump sequences\n", count == SOLUTION_COUNT_MAX ? "At least " : "",
+           formatSolutionCount(count).c_str());
+    printf("%llu positions in %d layers (widest %llu), %.2f s\n", (unsigned long long)stats.positions,
+           stats.layers, (unsigned long long)stats.widest, stats.seconds);
+    return 0;
+}
+
+int main(int argc, char *argv[]) {
+    GeometryId board = GEOMETRY_ENGLISH;
+    int emptyHole = -1;
+    int targetHole = -1;
+    uint64_t nodeLimit = 0;
+    int pruning = PRUNE_ALL;
+    int threads = 1;
+    bool comparing = false;
+    bool minimizeMoves = false;
+    bool counting = false;
+    bool fewest = false;
+    bool meeting = false;
+    const char *position = NULL;
+    const char *cachePath = NULL;
+    const char *catalogPath = NULL;
+    bool threadsSet = false;
+    int checkPositions = 0;
+
+    for (int i = 1; i < argc; i++) {
+        bool hasValue = i + 1 < argc;
+        if (strcmp(argv[i], "--board") == 0 && hasValue) {
+            if (!findGeometry(argv[++i], board)) {
+                fprintf(stderr, "Unknown board '%s'\n", argv[i]);
+                return 2;
+            }
+        } else if (strcmp(argv[i], "--empty") == 0 && hasValue) {
+            emptyHole = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--position") == 0 && hasValue) {
+            position = argv[++i];
+        } else if (strcmp(argv[i], "--target") == 0 && hasValue) {
+            targetHole = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--nodes") == 0 && hasValue) {
+            nodeLimit = strtoull(argv[++i], NULL, 10);
+        } else if (strcmp(argv[i], "--prune") == 0 && hasValue) {
+            if (!findPruning(argv[++i], pruning)) {
+                fprintf(stderr, "Unknown pruning rules '%s'\n", argv[i]);
+                return 2;
+            }
+        } else if (strcmp(argv[i], "--threads") == 0 && hasValue) {
+            threads = atoi(argv[++i]);
+            threadsSet = true;
+        } else if (strcmp(argv[i], "--compare") == 0) {
+            comparing = true;
+        } else if (strcmp(argv[i], "--moves") == 0) {
+            minimizeMoves = true;
+        } else if (strcmp(argv[i], "--count") == 0) {
+            counting = true;
+        } else if (strcmp(argv[i], "--fewest") == 0) {
+            fewest = true;
+        } else if (strcmp(argv[i], "--cache") == 0 && hasValue) {
+            cachePath = argv[++i];
+        } else if (strcmp(argv[i], "--bidirectional") == 0) {
+            meeting = true;
+        } else if (strcmp(argv[i], "--catalog") == 0 && hasValue) {
+            catalogPath = argv[++i];
+        } else if (strcmp(argv[i], "--check") == 0 && hasValue) {
+            checkPositions = atoi(argv[++i]);
+        } else {
+            usage();
+            return 2;
+        }
+    }
+
+    // Only the plain search keeps a dead-position table to save
+    if (cachePath && (minimizeMoves || counting || fewest || meeting || comparing || catalogPath || checkPositions > 0)) {
+        fprintf(stderr, "--cache only applies to the plain search, not with --moves, --count, --fewest, "
+                        "--bidirectional, --compare, --catalog or --check\n");
+        return 2;
+    }
+
+    if (catalogPath) {
+        CatalogOptions options = defaultCatalogOptions();
+        options.threads = threadsSet ? threads : (int)std::thread::hardware_concurrency();
+        options.nodeLimit = nodeLimit;
+        options.pruning = pruning;
+        options.minimizeMoves = minimizeMoves;
+        return catalog(board, catalogPath, options);
+    }
+
+    const Geometry &geo = getGeometry(board);
+    if (targetHole >= geo.numHoles)
+        targetHole = -1;
+    if (checkPositions > 0)
+        return checkMoves(board, targetHole, checkPositions) != 0;
+
+    Bitboard pegs;
+    if (position) {
+        if (!parsePosition(geo, position, pegs)) {
+            fprintf(stderr, "Position does not match the %s board (%dx%d grid)\n", geo.name, geo.rows, geo.cols);
+            return 2;
+        }
+    } else {
+        if (emptyHole < 0 || emptyHole >= geo.numHoles)
+            emptyHole = geo.defaultEmpty;
+        pegs = initialBoard(geo, emptyHole).pegs;
+    }
+
+    printf("%s, %d pegs\n%s\n\n", geo.name, bbPopCount(pegs), formatPosition(geo, pegs).c_str());
+
+    if (meeting)
+        return solveMeeting(board, pegs, targetHole, nodeLimit, comparing);
+    if (comparing) {
+        compare(board, pegs, targetHole, nodeLimit, threads);
+        return 0;
+    }
+    if (minimizeMoves)
+        return solveMoves(board, pegs, targetHole, nodeLimit);
+    if (counting)
+        return countLines(board, pegs, targetHole, threads);
+    if (fewest)
+        return solveFewest(board, pegs, nodeLimit);
+
+    Solver solver;
+    solver.setPruning(pruning);
+    solver.setThreads(threads);
+    if (cachePath && solver.loadTable(cachePath))
+        printf("Loaded dead-position table %s\n\n", cachePath);
+    std::vector<Move> line;
+    SolveResult result = solver.solve(board, pegs, line, targetHole, nodeLimit);
+    const SolverStats &stats = solver.stats();
+    if (cachePath)
+        solver.saveTable(cachePath);
+
+    if (result == SOLVE_WIN) {
+        printf("Solved in %d moves:\n", (int)line.size());
+        for (size_t i = 0; i < line.size(); i++) {
+            const Jump &j = moveJump(geo, line[i]);
+            printf("  %2d. %2d,%-2d -> %2d,%-2d\n", (int)i + 1, geo.holeRow[j.from], geo.holeCol[j.from],
+                   geo.holeRow[j.to], geo.holeCol[j.to]);
+        }
+    } else if (result == SOLVE_DEAD) {
+        printf("No solution\n");
+    } else {
+        printf("Gave up after %llu nodes\n", (unsigned long long)nodeLimit);
+    }
+    printf("\n%llu nodes, %llu dead-table hits, %llu pagoda cuts, %.3f s (%.2f M nodes/s)\n",
+           (unsigned long long)stats.nodes, (unsigned long long)stats.deadHits,
+           (unsigned long long)stats.pagodaCuts, stats.seconds,
+           stats.nodes / (stats.seconds > 0 ? stats.seconds : 1e-9) / 1e6);
+    if (stats.threadNodes.size() > 1) {
+        printf("\n%-8s %14s %8s\n", "thread", "nodes", "share");
+        for (size_t t = 0; t < stats.threadNodes.size(); t++)
+            printf("%-8d %14llu %7.1f%%\n", (int)t, (unsigned long long)stats.threadNodes[t],
+                   100.0 * stats.threadNodes[t] / (stats.nodes ? stats.nodes : 1));
+    }
+    return result == SOLVE_UNKNOWN ? 1 : 0;
+}